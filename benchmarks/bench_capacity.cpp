@@ -0,0 +1,70 @@
+// C++ Sytem includes
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+
+// Own libraries includes
+#include "VmeSystem.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace
+{
+constexpr int CYCLES = 2000;
+constexpr uint16_t LARGE_CRATE_ADCS = 4096;
+
+//! Sink discarding the reports.
+class NullSink : public streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+};
+
+//! Adc backend without bus transaction.
+int16_t readConstant(uint16_t, void*) { return TMOD_DEFAULT_ADC_VALUE; }
+
+/**
+ * @return Sweep rate [Hz] of a crate with the sensors first, first + step,
+ * and so on, below last.
+ */
+double sweepRate(uint16_t first, uint16_t step, uint16_t last)
+{
+    NullSink sink;
+    ostream output(&sink);
+    VmeSystem vmeSystem;
+    vmeSystem.setOutputStream(&output);
+    for (uint32_t hardwareId = first; hardwareId < last; hardwareId += step)
+        vmeSystem.addSensor((uint16_t)hardwareId, SensorType::VOLTAGE_0V_10V);
+
+    for (int cycle = 0; cycle < 5; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    const auto start = steady_clock::now();
+    for (int cycle = 0; cycle < CYCLES; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    const auto elapsed = steady_clock::now() - start;
+    return CYCLES / duration_cast<duration<double>>(elapsed).count();
+}
+} // namespace
+
+int main()
+{
+    tmodSetReadAdcBackend(&readConstant, nullptr);
+    const double small = sweepRate(0, 1, TMOD_MAX_ADCS);
+    printf("%-26s %10.1f sweeps/s\n", "14 channels", small);
+
+    tmodSetReadAdcBackend(&readConstant, nullptr, LARGE_CRATE_ADCS);
+    // Tables are dense: 14 sensors spread over the crate sweep as fast as
+    // 14 contiguous ones.
+    const double sparse = sweepRate(
+        0, (LARGE_CRATE_ADCS - 1) / (TMOD_MAX_ADCS - 1), LARGE_CRATE_ADCS);
+    printf("%-26s %10.1f sweeps/s  x%.2f\n", "14 of 4096 channels", sparse,
+           sparse / small);
+    const double large = sweepRate(0, 1, LARGE_CRATE_ADCS);
+    printf("%-26s %10.1f sweeps/s  %.1f channels/us\n", "4096 channels", large,
+           large * LARGE_CRATE_ADCS / 1e6);
+    tmodSetReadAdcBackend(nullptr, nullptr);
+    return 0;
+}
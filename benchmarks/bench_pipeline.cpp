@@ -0,0 +1,97 @@
+// C++ Sytem includes
+#include <chrono>
+#include <cstdio>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+
+// Own libraries includes
+#include "VmeSystem.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace
+{
+constexpr int CYCLES = 200;
+constexpr uint32_t BUS_LATENCY_US = 100;
+
+/**
+ * Sink taking a fixed time to store each report, like a slow disk or a
+ * remote collector.
+ */
+class SlowSink : public streambuf
+{
+public:
+    explicit SlowSink(microseconds latency) : latency(latency) {}
+
+protected:
+    int overflow(int c) override { return c; }
+    streamsize xsputn(const char*, streamsize n) override { return n; }
+    int sync() override
+    {
+        this_thread::sleep_for(latency);
+        return 0;
+    }
+
+private:
+    microseconds latency;
+};
+
+/**
+ * @return Sustained sweep rate [Hz].
+ */
+double sweepRate(VmeSystem& vmeSystem)
+{
+    // Warm-up, and the first cycles of the pipeline.
+    for (int cycle = 0; cycle < 5; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    const auto start = steady_clock::now();
+    for (int cycle = 0; cycle < CYCLES; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    const auto elapsed = steady_clock::now() - start;
+    return CYCLES / duration_cast<duration<double>>(elapsed).count();
+}
+} // namespace
+
+int main()
+{
+    VmeSystem vmeSystem;
+    for (uint16_t hardwareId = 0; hardwareId < TMOD_MAX_ADCS; hardwareId++)
+        vmeSystem.addSensor(hardwareId, SensorType::VOLTAGE_0V_10V);
+    tmodSetBusLatency(BUS_LATENCY_US);
+
+    // Processing as slow as the bus: the best case for the pipeline.
+    const auto busStart = steady_clock::now();
+    for (uint16_t hardwareId = 0; hardwareId < TMOD_MAX_ADCS; hardwareId++)
+        tmodReadAdc(hardwareId);
+    const auto busTime =
+        duration_cast<microseconds>(steady_clock::now() - busStart);
+    SlowSink sink(busTime);
+    ostream output(&sink);
+    vmeSystem.setOutputStream(&output);
+
+    // Report time: a serial cycle without bus latency, sink included.
+    tmodSetBusLatency(0);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    const auto reportStart = steady_clock::now();
+    for (int cycle = 0; cycle < CYCLES; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    const auto reportTime = duration_cast<microseconds>(
+        (steady_clock::now() - reportStart) / CYCLES);
+    tmodSetBusLatency(BUS_LATENCY_US);
+    printf("%d channels, bus sweep %lld us, report %lld us\n", TMOD_MAX_ADCS,
+           (long long)busTime.count(), (long long)reportTime.count());
+
+    const double serial = sweepRate(vmeSystem);
+    printf("%-20s %8.1f sweeps/s\n", "serial", serial);
+    for (size_t cycleBuffers : {2, 3, 4})
+    {
+        vmeSystem.startPipeline(cycleBuffers);
+        const double pipelined = sweepRate(vmeSystem);
+        vmeSystem.stopPipeline();
+        printf("pipeline, %zu buffers %8.1f sweeps/s  x%.2f\n", cycleBuffers,
+               pipelined, pipelined / serial);
+    }
+    return 0;
+}
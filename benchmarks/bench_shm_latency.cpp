@@ -0,0 +1,134 @@
+// C includes
+#include <sys/wait.h>
+#include <unistd.h>
+
+// C++ Sytem includes
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Own libraries includes
+#include "ShmClient.h"
+#include "ShmPublisher.h"
+
+using namespace std;
+using namespace std::chrono;
+
+namespace
+{
+constexpr int CYCLES = 2000;
+//! Cycles published per phase, a few more than measured.
+constexpr int PHASE_CYCLES = CYCLES + 10;
+constexpr auto PERIOD = microseconds(200);
+//! Longest phase, in case the publisher is gone.
+constexpr auto PHASE_TIMEOUT = seconds(10);
+
+int64_t nowNs()
+{
+    return duration_cast<nanoseconds>(system_clock::now().time_since_epoch())
+        .count();
+}
+
+void printPercentiles(const char* title, vector<int64_t>& latencies)
+{
+    if (latencies.empty())
+    {
+        printf("%-28s no cycle observed\n", title);
+        return;
+    }
+    sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        return latencies[(size_t)(p * (double)(latencies.size() - 1))];
+    };
+    printf("%-28s p50 %7lld ns  p99 %7lld ns  max %7lld ns\n", title,
+           (long long)percentile(0.5), (long long)percentile(0.99),
+           (long long)latencies.back());
+}
+
+/**
+ * Reader process: measure the cost of a read, then the delay between the
+ * publication of a cycle and its observation, polling or waiting.
+ */
+int reader(const string& name)
+{
+    ShmClient client(name);
+
+    ShmChannelReading reading;
+    const int reads = 1000000;
+    const auto start = steady_clock::now();
+    for (int i = 0; i < reads; i++)
+        client.readChannel((uint16_t)(i % client.getChannelCapacity()),
+                           reading);
+    const auto elapsed = steady_clock::now() - start;
+    printf("%-28s %7lld ns\n", "readChannel",
+           (long long)(duration_cast<nanoseconds>(elapsed).count() / reads));
+
+    uint64_t lastCycle = 0;
+    for (const bool wait : {false, true})
+    {
+        // Cycles may be missed: the phase ends with its last cycle.
+        lastCycle += PHASE_CYCLES;
+        const auto deadline = steady_clock::now() + PHASE_TIMEOUT;
+        vector<int64_t> latencies;
+        uint64_t seen = client.getLatestCycle();
+        while ((int)latencies.size() < CYCLES && seen < lastCycle &&
+               steady_clock::now() < deadline)
+        {
+            const uint64_t latest =
+                wait ? client.waitForCycle(seen, seconds(1))
+                     : client.getLatestCycle();
+            if (latest == seen)
+                continue;
+            const int64_t observedNs = nowNs();
+            client.readChannel(0, reading);
+            latencies.push_back(observedNs - reading.timestampNs);
+            seen = latest;
+        }
+        printPercentiles(wait ? "publish to wake (futex)"
+                              : "publish to observe (poll)",
+                         latencies);
+    }
+    fflush(stdout);
+    return 0;
+}
+} // namespace
+
+/**
+ * Latency of the shared-memory publication, between two processes.
+ */
+int main()
+{
+    const string name = "/ttt_bench_" + to_string(getpid());
+    ShmPublisher publisher(name);
+
+    SweepSnapshot snapshot;
+    for (uint16_t c = 0; c < TMOD_MAX_ADCS; c++)
+        snapshot.readings.push_back({c, 0, 0.f, 0.f, 0.f});
+
+    // The child leaves with _exit: destroying its copy of the publisher
+    // would unlink the segment of the parent.
+    const pid_t child = fork();
+    if (child == 0)
+        _exit(reader(name));
+
+    // Leave the reader time to measure the read cost.
+    this_thread::sleep_for(seconds(1));
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < PHASE_CYCLES; i++)
+        {
+            snapshot.cycle++;
+            snapshot.timestampNs = nowNs();
+            publisher.publish(snapshot);
+            this_thread::sleep_for(PERIOD);
+        }
+        this_thread::sleep_for(milliseconds(100));
+    }
+
+    int status = 0;
+    waitpid(child, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : 1;
+}
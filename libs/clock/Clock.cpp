@@ -0,0 +1,64 @@
+// STD includes
+#include <thread>
+
+// Local includes
+#include "Clock.h"
+
+using namespace std;
+
+void Clock::sleepUntil(chrono::steady_clock::time_point deadline)
+{
+    sleepFor(deadline - steadyNow());
+}
+
+chrono::system_clock::time_point RealClock::now() const
+{
+    return chrono::system_clock::now();
+}
+
+chrono::steady_clock::time_point RealClock::steadyNow() const
+{
+    return chrono::steady_clock::now();
+}
+
+void RealClock::sleepFor(chrono::nanoseconds duration)
+{
+    if (duration > chrono::nanoseconds::zero())
+        this_thread::sleep_for(duration);
+}
+
+VirtualClock::VirtualClock(chrono::system_clock::time_point start)
+    : start(start)
+{
+}
+
+chrono::system_clock::time_point VirtualClock::now() const
+{
+    return start + chrono::duration_cast<chrono::system_clock::duration>(
+                       getElapsed());
+}
+
+chrono::steady_clock::time_point VirtualClock::steadyNow() const
+{
+    return chrono::steady_clock::time_point(
+        chrono::duration_cast<chrono::steady_clock::duration>(getElapsed()));
+}
+
+void VirtualClock::sleepFor(chrono::nanoseconds duration) { advance(duration); }
+
+void VirtualClock::advance(chrono::nanoseconds duration)
+{
+    if (duration > chrono::nanoseconds::zero())
+        elapsedNs.fetch_add(duration.count());
+}
+
+chrono::nanoseconds VirtualClock::getElapsed() const
+{
+    return chrono::nanoseconds(elapsedNs.load());
+}
+
+Clock& realClock()
+{
+    static RealClock clock;
+    return clock;
+}
@@ -0,0 +1,95 @@
+#ifndef TAKING_THE_TEMPERATURE_CLOCK_H
+#define TAKING_THE_TEMPERATURE_CLOCK_H
+
+// STD includes
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+using namespace std;
+
+/**
+ * @brief Source of time of the acquisition chain.
+ * Everything that time-stamps, measures a duration or waits goes through a
+ * Clock, so that a VirtualClock can run weeks of cycles in seconds.
+ */
+class Clock
+{
+public:
+    virtual ~Clock() = default;
+
+    /**
+     * @brief Wall-clock time, for the time stamps.
+     */
+    [[nodiscard]] virtual chrono::system_clock::time_point now() const = 0;
+
+    /**
+     * @brief Monotonic time, for the durations and the deadlines.
+     */
+    [[nodiscard]] virtual chrono::steady_clock::time_point
+    steadyNow() const = 0;
+
+    /**
+     * @brief Block the calling thread for a duration.
+     * Does nothing if the duration is not positive.
+     */
+    virtual void sleepFor(chrono::nanoseconds duration) = 0;
+
+    /**
+     * @brief Block the calling thread until a monotonic deadline.
+     */
+    void sleepUntil(chrono::steady_clock::time_point deadline);
+};
+
+/**
+ * @brief The system clocks.
+ */
+class RealClock : public Clock
+{
+public:
+    [[nodiscard]] chrono::system_clock::time_point now() const override;
+    [[nodiscard]] chrono::steady_clock::time_point steadyNow() const override;
+    void sleepFor(chrono::nanoseconds duration) override;
+};
+
+/**
+ * @brief Clock whose time only moves when told to.
+ * Sleeping advances the time at once instead of blocking. Thread safe, all
+ * the threads share the same time line.
+ */
+class VirtualClock : public Clock
+{
+public:
+    /**
+     * @param start: wall-clock time at creation, 2020-01-01 00:00:00 UTC by
+     * default. The monotonic time starts at the steady clock epoch.
+     */
+    explicit VirtualClock(chrono::system_clock::time_point start =
+                              chrono::system_clock::from_time_t(1577836800));
+
+    [[nodiscard]] chrono::system_clock::time_point now() const override;
+    [[nodiscard]] chrono::steady_clock::time_point steadyNow() const override;
+    void sleepFor(chrono::nanoseconds duration) override;
+
+    /**
+     * @brief Move the time forward.
+     * Does nothing if the duration is not positive.
+     */
+    void advance(chrono::nanoseconds duration);
+
+    /**
+     * @brief Get the time elapsed since creation.
+     */
+    [[nodiscard]] chrono::nanoseconds getElapsed() const;
+
+private:
+    chrono::system_clock::time_point start;
+    atomic<int64_t> elapsedNs{0};
+};
+
+/**
+ * @brief Process-wide real clock, the default of every component.
+ */
+Clock& realClock();
+
+#endif // TAKING_THE_TEMPERATURE_CLOCK_H
@@ -0,0 +1,396 @@
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+// Third parties includes
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/format.hpp>
+#include <yaml-cpp/yaml.h>
+
+// Local includes
+#include "ReplayBackend.h"
+
+using namespace std;
+
+namespace
+{
+constexpr char CAPTURE_MAGIC[4] = {'T', 'T', 'R', 'C'};
+constexpr uint16_t CAPTURE_VERSION = 1;
+
+int64_t toEpochMillisec(const string& timestamp)
+{
+    using namespace boost::posix_time;
+    const ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return (time_from_string(timestamp) - epoch).total_milliseconds();
+}
+
+int16_t toAdcValue(float temperature, float scalingFactor, float offset)
+{
+    if (scalingFactor == 0.f)
+        return TMOD_INVALID_VOLTAGE_MEASUREMENT;
+
+    // NaN would be clamped to full scale: faulted sensors, reported with
+    // .nan temperatures, are replayed as invalid measurements instead.
+    const float adcValue = roundf((temperature - offset) / scalingFactor);
+    if (!isfinite(adcValue))
+        return TMOD_INVALID_VOLTAGE_MEASUREMENT;
+    return (int16_t)max((float)INT16_MIN, min((float)INT16_MAX, adcValue));
+}
+
+template <typename T>
+void writeValue(ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void readValue(ifstream& file, T& value, const string& path)
+{
+    if (!file.read(reinterpret_cast<char*>(&value), sizeof(T)))
+    {
+        const string errorMessage =
+            str(boost::format("Capture %1% is truncated.") % path);
+        throw runtime_error(errorMessage);
+    }
+}
+} // namespace
+
+Recording Recording::fromReportYaml(const string& path)
+{
+    YAML::Node report;
+    try
+    {
+        report = YAML::LoadFile(path);
+    }
+    catch (const YAML::Exception& e)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to parse report %1%: %2%") % path %
+                e.what());
+        throw runtime_error(errorMessage);
+    }
+    if (!report.IsMap())
+    {
+        const string errorMessage =
+            str(boost::format("Report %1% is not a map of readings.") % path);
+        throw runtime_error(errorMessage);
+    }
+
+    // First pass: collect frames, as hardware Id to Adc value.
+    vector<pair<int64_t, map<uint16_t, int16_t>>> frames;
+    uint32_t channelCount = 0;
+    for (YAML::const_iterator i = report.begin(); i != report.end(); ++i)
+    {
+        map<uint16_t, int16_t> frame;
+        for (YAML::const_iterator j = i->second.begin(); j != i->second.end();
+             ++j)
+        {
+            // Non-const copy: indexing a const node makes yaml-cpp build
+            // temporaries that -Wdangling-pointer complains about.
+            YAML::Node sensorNode = j->second;
+            const auto hardwareId = sensorNode["Hardware Id"].as<uint16_t>();
+            if (hardwareId == UINT16_MAX)
+            {
+                const string errorMessage =
+                    str(boost::format("Hardware Id %1% of report %2% is out "
+                                      "of range.") %
+                        hardwareId % path);
+                throw runtime_error(errorMessage);
+            }
+            const YAML::Node status = sensorNode["Status"];
+            if (status && status.as<string>() == "Fault")
+                frame[hardwareId] = TMOD_INVALID_VOLTAGE_MEASUREMENT;
+            else
+                frame[hardwareId] =
+                    toAdcValue(sensorNode["Temperature"].as<float>(),
+                               sensorNode["Scaling factor"].as<float>(),
+                               sensorNode["Offset"].as<float>());
+            channelCount = max(channelCount, (uint32_t)hardwareId + 1);
+        }
+        frames.emplace_back(toEpochMillisec(i->first.as<string>()),
+                            move(frame));
+    }
+
+    Recording recording;
+    recording.setChannelCount((uint16_t)channelCount);
+    vector<int16_t> frame(channelCount);
+    for (size_t first = 0; first < frames.size();)
+    {
+        // Frames of the same second are spread evenly over that second.
+        size_t last = first;
+        while (last < frames.size() &&
+               frames[last].first == frames[first].first)
+            last++;
+        const auto sameSecond = (int64_t)(last - first);
+        for (size_t k = first; k < last; k++)
+        {
+            fill(frame.begin(), frame.end(), TMOD_INVALID_VOLTAGE_MEASUREMENT);
+            for (const auto& [hardwareId, adcValue] : frames[k].second)
+                frame[hardwareId] = adcValue;
+            recording.addFrame(frames[k].first +
+                                   (int64_t)(k - first) * 1000 / sameSecond,
+                               frame);
+        }
+        first = last;
+    }
+    return recording;
+}
+
+Recording Recording::fromCapture(const string& path)
+{
+    ifstream file(path, ios::binary);
+    if (!file)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to access %1%.") % path);
+        throw runtime_error(errorMessage);
+    }
+
+    char magic[sizeof(CAPTURE_MAGIC)];
+    uint16_t version = 0;
+    readValue(file, magic, path);
+    readValue(file, version, path);
+    if (!equal(begin(magic), end(magic), begin(CAPTURE_MAGIC)) ||
+        version != CAPTURE_VERSION)
+    {
+        const string errorMessage =
+            str(boost::format("%1% is not a version %2% capture.") % path %
+                CAPTURE_VERSION);
+        throw runtime_error(errorMessage);
+    }
+
+    Recording recording;
+    uint16_t channelCount = 0;
+    uint64_t frameCount = 0;
+    readValue(file, channelCount, path);
+    readValue(file, frameCount, path);
+    recording.setChannelCount(channelCount);
+
+    vector<int16_t> frame(channelCount);
+    for (uint64_t f = 0; f < frameCount; f++)
+    {
+        int64_t timestampMs = 0;
+        readValue(file, timestampMs, path);
+        for (auto& adcValue : frame)
+            readValue(file, adcValue, path);
+        recording.addFrame(timestampMs, frame);
+    }
+    return recording;
+}
+
+void Recording::saveCapture(const string& path) const
+{
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to access %1%.") % path);
+        throw runtime_error(errorMessage);
+    }
+
+    file.write(CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+    writeValue(file, CAPTURE_VERSION);
+    writeValue(file, channelCount);
+    writeValue(file, (uint64_t)getFrameCount());
+    for (size_t f = 0; f < getFrameCount(); f++)
+    {
+        writeValue(file, timestampsMs[f]);
+        file.write(reinterpret_cast<const char*>(&samples[f * channelCount]),
+                   channelCount * sizeof(int16_t));
+    }
+
+    if (!file)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to write capture %1%.") % path);
+        throw runtime_error(errorMessage);
+    }
+}
+
+void Recording::addFrame(int64_t timestampMs, const vector<int16_t>& frame)
+{
+    if (frame.size() != channelCount)
+    {
+        const string errorMessage =
+            str(boost::format("Frame holds %1% channels instead of %2%.") %
+                frame.size() % channelCount);
+        throw invalid_argument(errorMessage);
+    }
+
+    timestampsMs.push_back(timestampMs);
+    samples.insert(samples.end(), frame.begin(), frame.end());
+    for (uint16_t channel = 0; channel < channelCount; channel++)
+    {
+        if (frame[channel] == TMOD_INVALID_VOLTAGE_MEASUREMENT)
+            continue;
+        auto it = lower_bound(recordedChannels.begin(), recordedChannels.end(),
+                              channel);
+        if (it == recordedChannels.end() || *it != channel)
+            recordedChannels.insert(it, channel);
+    }
+}
+
+void Recording::setChannelCount(uint16_t newChannelCount)
+{
+    if (!timestampsMs.empty())
+        throw logic_error("Channel count of a non empty recording is fixed.");
+    channelCount = newChannelCount;
+}
+
+uint16_t Recording::getChannelCount() const { return channelCount; }
+
+size_t Recording::getFrameCount() const { return timestampsMs.size(); }
+
+const vector<uint16_t>& Recording::getRecordedChannels() const
+{
+    return recordedChannels;
+}
+
+int64_t Recording::getTimestampMs(size_t frame) const
+{
+    return timestampsMs.at(frame);
+}
+
+int16_t Recording::getSample(size_t frame, uint16_t channel) const
+{
+    return samples.at(frame * channelCount + channel);
+}
+
+ReplayBackend::ReplayBackend(Recording recording, ReplayMode mode,
+                             double speed, Clock& clock)
+    : recording(move(recording)), mode(mode), speed(speed), clock(clock)
+{
+    if (this->recording.getFrameCount() == 0)
+        throw invalid_argument("Impossible to replay an empty recording.");
+    if (speed <= 0.)
+    {
+        const string errorMessage =
+            str(boost::format("Replay speed (%1%) should be positive.") %
+                speed);
+        throw invalid_argument(errorMessage);
+    }
+    if (mode == REAL_TIME)
+        this->speed = 1.;
+
+    // One pass lasts the recorded span plus one last sampling interval.
+    const size_t frameCount = this->recording.getFrameCount();
+    const int64_t span = this->recording.getTimestampMs(frameCount - 1) -
+                         this->recording.getTimestampMs(0);
+    const int64_t lastInterval =
+        frameCount > 1
+            ? span - (this->recording.getTimestampMs(frameCount - 2) -
+                      this->recording.getTimestampMs(0))
+            : 1000;
+    periodMs = max<int64_t>(1, span + lastInterval);
+
+    lastSweep.assign(this->recording.getChannelCount(), 0);
+    start = clock.steadyNow();
+}
+
+ReplayBackend::~ReplayBackend() { uninstall(); }
+
+void ReplayBackend::install()
+{
+    installed = true;
+    start = clock.steadyNow();
+    sweepFrame = 0;
+    fill(lastSweep.begin(), lastSweep.end(), 0);
+    sweep = 1;
+    const uint16_t channels = max(fanOut, recording.getChannelCount());
+    tmodSetReadAdcBackend(&ReplayBackend::readAdcTrampoline, this,
+                          max<uint16_t>(channels, TMOD_MAX_ADCS));
+}
+
+void ReplayBackend::uninstall()
+{
+    // Another backend may have replaced this one since.
+    if (installed && tmodGetReadAdcBackendContext() == this)
+        tmodSetReadAdcBackend(nullptr, nullptr);
+    installed = false;
+}
+
+void ReplayBackend::setFanOut(uint16_t syntheticChannels)
+{
+    if (syntheticChannels > 0 && recording.getRecordedChannels().empty())
+        throw invalid_argument("No recorded channel to fan out.");
+
+    fanOut = syntheticChannels;
+    lastSweep.assign(max(fanOut, recording.getChannelCount()), 0);
+}
+
+void ReplayBackend::setLooping(bool newLooping) { looping = newLooping; }
+
+int16_t ReplayBackend::readAdc(uint16_t hardwareAddress)
+{
+    uint16_t channel = hardwareAddress;
+    size_t frameShift = 0;
+    if (fanOut > 0)
+    {
+        if (hardwareAddress >= fanOut)
+            return TMOD_INVALID_VOLTAGE_MEASUREMENT;
+        const vector<uint16_t>& channels = recording.getRecordedChannels();
+        channel = channels[hardwareAddress % channels.size()];
+        frameShift = hardwareAddress / channels.size();
+    }
+    else if (hardwareAddress >= recording.getChannelCount())
+        return TMOD_INVALID_VOLTAGE_MEASUREMENT;
+
+    if (mode == AS_FAST_AS_POSSIBLE)
+    {
+        // Reading a channel twice means a new sweep has started.
+        if (lastSweep[hardwareAddress] == sweep)
+        {
+            sweep++;
+            sweepFrame++;
+        }
+        lastSweep[hardwareAddress] = sweep;
+    }
+
+    return recording.getSample(frameAt(frameShift), channel);
+}
+
+size_t ReplayBackend::getCurrentFrame() { return frameAt(0); }
+
+const Recording& ReplayBackend::getRecording() const { return recording; }
+
+size_t ReplayBackend::frameAt(size_t frameShift)
+{
+    const size_t frameCount = recording.getFrameCount();
+    size_t frame = sweepFrame;
+    if (mode != AS_FAST_AS_POSSIBLE)
+    {
+        const auto elapsed = clock.steadyNow() - start;
+        auto elapsedMs = (int64_t)(
+            (double)chrono::duration_cast<chrono::milliseconds>(elapsed)
+                .count() *
+            speed);
+        if (looping)
+            elapsedMs %= periodMs;
+
+        const int64_t first = recording.getTimestampMs(0);
+        size_t lower = 0;
+        size_t upper = frameCount;
+        // Last frame recorded at or before the replay position.
+        while (upper - lower > 1)
+        {
+            const size_t middle = (lower + upper) / 2;
+            if (recording.getTimestampMs(middle) - first <= elapsedMs)
+                lower = middle;
+            else
+                upper = middle;
+        }
+        frame = lower;
+    }
+
+    frame += frameShift;
+    return looping ? frame % frameCount : min(frame, frameCount - 1);
+}
+
+int16_t ReplayBackend::readAdcTrampoline(uint16_t hardwareAddress,
+                                         void* context)
+{
+    return static_cast<ReplayBackend*>(context)->readAdc(hardwareAddress);
+}
@@ -0,0 +1,183 @@
+#ifndef TAKING_THE_TEMPERATURE_REPLAYBACKEND_H
+#define TAKING_THE_TEMPERATURE_REPLAYBACKEND_H
+
+// STD includes
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local includes
+#include "Clock.h"
+#include "tmod.h"
+
+using namespace std;
+
+enum ReplayMode
+{
+    REAL_TIME = 0,          /**< Frames follow the recorded timestamps */
+    ACCELERATED = 1,        /**< Recorded timestamps divided by a speed */
+    AS_FAST_AS_POSSIBLE = 2 /**< One frame per sweep over the channels */
+};
+
+/**
+ * @brief Recorded Adc sample streams.
+ * Samples are stored frame-major in a dense channel table: frame f of
+ * channel c is at samples[f * channelCount + c]. Channels missing from a
+ * frame hold TMOD_INVALID_VOLTAGE_MEASUREMENT.
+ */
+class Recording
+{
+public:
+    /**
+     * @brief Build a recording from a report produced by VmeSystem.
+     * Temperatures are converted back to Adc values with the scaling data
+     * stored alongside them. Reports written several times within the same
+     * second share a timestamp, so those frames are spread evenly over that
+     * second.
+     * @param path: path to the report.yaml file.
+     * @throw runtime_error: if the file cannot be parsed.
+     */
+    static Recording fromReportYaml(const string& path);
+
+    /**
+     * @brief Load a binary capture written by saveCapture().
+     * @param path: path to the capture file.
+     * @throw runtime_error: if the file cannot be read or is not a capture.
+     */
+    static Recording fromCapture(const string& path);
+
+    /**
+     * @brief Save the recording in the binary capture format.
+     * The format is a "TTRC" magic, a version, the channel table and the
+     * frames (timestamp in ms followed by one int16 per channel), in host
+     * byte order.
+     * @param path: path to the capture file.
+     * @throw runtime_error: if the file cannot be written.
+     */
+    void saveCapture(const string& path) const;
+
+    /**
+     * @brief Append a frame.
+     * @param timestampMs: time of the frame, in ms since epoch.
+     * @param frame: one Adc value per channel, channelCount values.
+     * @throw invalid_argument: if the frame width does not match.
+     */
+    void addFrame(int64_t timestampMs, const vector<int16_t>& frame);
+
+    /**
+     * @brief Set the width of the channel table.
+     * Only allowed while the recording holds no frame.
+     * @throw logic_error: if frames have already been added.
+     */
+    void setChannelCount(uint16_t channelCount);
+
+    [[nodiscard]] uint16_t getChannelCount() const;
+
+    [[nodiscard]] size_t getFrameCount() const;
+
+    /**
+     * @brief Get the channels holding at least one valid sample.
+     * @return Sorted list of channels.
+     */
+    [[nodiscard]] const vector<uint16_t>& getRecordedChannels() const;
+
+    [[nodiscard]] int64_t getTimestampMs(size_t frame) const;
+
+    [[nodiscard]] int16_t getSample(size_t frame, uint16_t channel) const;
+
+private:
+    uint16_t channelCount = 0;
+    vector<int64_t> timestampsMs;
+    vector<int16_t> samples;
+    vector<uint16_t> recordedChannels;
+};
+
+/**
+ * @brief tmod backend replaying a recording into tmodReadAdc().
+ * Once installed, every Adc reading made through tmod is served from the
+ * recording. The recording loops when its end is reached, unless looping is
+ * disabled in which case the last frame is held.
+ */
+class ReplayBackend
+{
+public:
+    /**
+     * @param recording: recording to replay, with at least one frame.
+     * @param mode: how frames advance.
+     * @param speed: acceleration factor, only used in ACCELERATED mode.
+     * @param clock: clock of the REAL_TIME and ACCELERATED modes, not owned.
+     * @throw invalid_argument: if the recording is empty or speed is not
+     * strictly positive.
+     */
+    explicit ReplayBackend(Recording recording, ReplayMode mode = REAL_TIME,
+                           double speed = 1., Clock& clock = realClock());
+
+    //! Uninstall the backend if it is still installed.
+    ~ReplayBackend();
+
+    ReplayBackend(const ReplayBackend&) = delete;
+    ReplayBackend& operator=(const ReplayBackend&) = delete;
+
+    /**
+     * @brief Route tmodReadAdc() to this backend and restart the replay.
+     * The backend serves at least TMOD_MAX_ADCS channels, more if the
+     * recording or the fan-out has more of them.
+     */
+    void install();
+
+    /**
+     * @brief Restore the dummy tmod implementation, if this backend is the
+     * one installed.
+     */
+    void uninstall();
+
+    /**
+     * @brief Fan the recording out across synthetic channels.
+     * Synthetic channel c replays recorded channel
+     * getRecordedChannels()[c % n], shifted by c / n frames so that replicas
+     * do not read identical values. 0 disables the fan-out, channels are
+     * then the recorded ones. Set it before install().
+     * @param syntheticChannels: number of synthetic channels.
+     */
+    void setFanOut(uint16_t syntheticChannels);
+
+    void setLooping(bool looping);
+
+    /**
+     * @brief Read an Adc value at the current replay position.
+     * @return Adc value, or TMOD_INVALID_VOLTAGE_MEASUREMENT if the channel
+     * is not part of the recording.
+     */
+    int16_t readAdc(uint16_t hardwareAddress);
+
+    /**
+     * @brief Get the frame served at the current replay position.
+     */
+    [[nodiscard]] size_t getCurrentFrame();
+
+    [[nodiscard]] const Recording& getRecording() const;
+
+private:
+    Recording recording;
+    ReplayMode mode;
+    double speed;
+    Clock& clock;
+    bool looping = true;
+    bool installed = false;
+    uint16_t fanOut = 0;
+    chrono::steady_clock::time_point start;
+    /// Duration of one pass over the recording, used to loop.
+    int64_t periodMs = 0;
+    /// Frame index in AS_FAST_AS_POSSIBLE mode.
+    size_t sweepFrame = 0;
+    /// Sweep during which each channel was last read.
+    vector<size_t> lastSweep;
+    size_t sweep = 1;
+
+    size_t frameAt(size_t frameShift);
+
+    static int16_t readAdcTrampoline(uint16_t hardwareAddress, void* context);
+};
+
+#endif // TAKING_THE_TEMPERATURE_REPLAYBACKEND_H
@@ -1,36 +1,38 @@
-// C includes
-#include <fcntl.h>
-
 // C++ Sytem includes
+#include <memory>
 #include <string>
-#include <thread>
 
 // Third parties C++ includes
-#include <boost/format.hpp>
-#include <boost/iostreams/device/file_descriptor.hpp>
-#include <boost/iostreams/stream_buffer.hpp>
 #include <boost/regex.hpp>
 
 // Own libraries includes
+#include "CycleScheduler.h"
+#include "ReplayBackend.h"
+#include "ReportWriter.h"
 #include "VmeSystem.h"
 
 using namespace std::chrono;
 
-int main()
+int main(int argc, char* argv[])
 {
-    // Open file output stream properly.
-    // See https://security.web.cern.ch/recommendations/en/codetools/cpp.shtml
-    std::string filename = "report.yaml";
-    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0600);
-    if (fd == -1)
+    // Optionally replay a previous report instead of the dummy tmod, as fast
+    // as possible: supervision path/to/report.yaml
+    unique_ptr<ReplayBackend> replay;
+    if (argc > 1)
     {
-        const std::string errorMessage =
-            str(boost::format("Impossible to access %1%.") % filename);
-        throw std::invalid_argument(errorMessage);
+        replay = make_unique<ReplayBackend>(Recording::fromReportYaml(argv[1]),
+                                            AS_FAST_AS_POSSIBLE);
+        replay->install();
     }
-    io::stream_buffer<io::file_descriptor_sink> fp(
-        fd, boost::iostreams::close_handle);
-    std::ostream out(&fp);
+
+    // Reports are committed to the file 5 cycles at a time, synced every
+    // second and rotated every 10 MB.
+    ReportWriterConfig config;
+    config.cyclesPerBatch = 5;
+    config.fsyncPolicy = FSYNC_EVERY_T_MS;
+    config.fsyncPeriod = std::chrono::milliseconds(1000);
+    config.rotationSize = 10 * 1024 * 1024;
+    ReportWriter writer("report.yaml", config);
 
     // Instantiate Vme system.
     VmeSystem v;
@@ -55,7 +57,7 @@ int main()
     }
 
     // Set output stream
-    v.setOutputStream(&out);
+    v.setOutputStream(&writer.getStream());
 
     // Get a map, instead of a list, of the temperature sensors registered in
     // the VME system.
@@ -64,25 +66,11 @@ int main()
 
     // Produce report, the supervision is in charge of triggering it.
     // For brevity, report is performed every 100ms instead of 60 seconds.
-    const chrono::milliseconds timeWindow = std::chrono::milliseconds(100);
-    int i = 0;
-    while (i < 10)
-    {
-        i++;
-        time_point<steady_clock> start = std::chrono::steady_clock::now();
-        v.measureTemperaturesAndProduceReport();
-        time_point<steady_clock> end = std::chrono::steady_clock::now();
-        auto elapsed = end - start;
-
-        auto timeToWait = timeWindow - elapsed;
-        if (timeToWait > std::chrono::milliseconds::zero())
-        {
-            std::this_thread::sleep_for(timeToWait);
-        }
-    }
+    CycleScheduler scheduler(realClock(), std::chrono::milliseconds(100));
+    scheduler.run(10, [&v]() { v.measureTemperaturesAndProduceReport(); });
 
     // At the end of the application, the VME system object is destroyed
-    // and the ostream is closed.
+    // and the report writer commits the pending cycles.
 
     return 0;
 }
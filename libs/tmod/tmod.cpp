@@ -3,23 +3,38 @@
 #include <boost/generator_iterator.hpp>
 #include <boost/random.hpp>
 
+#include "Clock.h"
 #include "tmod.h"
 
+#include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <iostream>
 
+static TmodReadAdcBackend readAdcBackend = nullptr;
+static void* readAdcBackendContext = nullptr;
+static std::atomic<uint16_t> maxAdcs(TMOD_MAX_ADCS);
+static std::atomic<uint32_t> busLatency(0);
+static std::atomic<Clock*> tmodClock(&realClock());
+
 uint64_t timeSinceEpochMillisec()
 {
     using namespace std::chrono;
-    return duration_cast<milliseconds>(system_clock::now().time_since_epoch())
+    return duration_cast<milliseconds>(
+               tmodClock.load()->now().time_since_epoch())
         .count();
 }
 
 int16_t tmodReadAdc(uint16_t hardwareAddress)
 {
+    if (const uint32_t latency = busLatency.load(std::memory_order_relaxed))
+        tmodClock.load()->sleepFor(std::chrono::microseconds(latency));
+
+    if (readAdcBackend != nullptr)
+        return readAdcBackend(hardwareAddress, readAdcBackendContext);
+
     // Hardware address can't be negative as it is uint16_t.
-    if (hardwareAddress > tmodMaxAdcs())
+    if (hardwareAddress >= tmodMaxAdcs())
         return TMOD_INVALID_VOLTAGE_MEASUREMENT;
 
     boost::mt19937 rng(timeSinceEpochMillisec());
@@ -29,4 +44,27 @@ int16_t tmodReadAdc(uint16_t hardwareAddress)
     return randomMeasurement();
 }
 
-uint16_t tmodMaxAdcs() { return TMOD_MAX_ADCS; }
+uint16_t tmodMaxAdcs() { return maxAdcs.load(std::memory_order_relaxed); }
+
+void tmodSetReadAdcBackend(TmodReadAdcBackend backend, void* context,
+                           uint16_t backendMaxAdcs)
+{
+    readAdcBackend = backend;
+    readAdcBackendContext = context;
+    maxAdcs.store(backend != nullptr ? backendMaxAdcs : TMOD_MAX_ADCS);
+}
+
+void* tmodGetReadAdcBackendContext()
+{
+    return readAdcBackend != nullptr ? readAdcBackendContext : nullptr;
+}
+
+void tmodSetBusLatency(uint32_t microseconds)
+{
+    busLatency.store(microseconds);
+}
+
+void tmodSetClock(Clock* clock)
+{
+    tmodClock.store(clock != nullptr ? clock : &realClock());
+}
@@ -7,6 +7,9 @@
 
 #include <cstdint>
 
+class Clock;
+
+//! Channels of the dummy implementation.
 constexpr uint8_t TMOD_MAX_ADCS = 14;
 constexpr int16_t TMOD_DEFAULT_ADC_VALUE = 4;
 constexpr int16_t TMOD_INVALID_VOLTAGE_MEASUREMENT = -1;
@@ -14,6 +17,46 @@ constexpr uint16_t TMOD_MAX_ADC_VALUE = 16383;
 
 int16_t tmodReadAdc(uint16_t hardwareAddress);
 
+/**
+ * Number of Adcs of the current backend: hardware addresses go from 0 to
+ * tmodMaxAdcs() - 1. A backend serves at most UINT16_MAX Adcs, address
+ * UINT16_MAX is never valid.
+ */
 uint16_t tmodMaxAdcs();
 
+/**
+ * Alternative Adc reading backend, e.g. a replay of recorded data.
+ * @param hardwareAddress: address of the Adc to read.
+ * @param context: opaque pointer given to tmodSetReadAdcBackend().
+ */
+typedef int16_t (*TmodReadAdcBackend)(uint16_t hardwareAddress,
+                                      void* context);
+
+/**
+ * Route tmodReadAdc() to another backend.
+ * Passing nullptr restores the dummy random implementation, and its
+ * TMOD_MAX_ADCS channels.
+ * @param maxAdcs: number of Adcs served by the backend.
+ */
+void tmodSetReadAdcBackend(TmodReadAdcBackend backend, void* context,
+                           uint16_t maxAdcs = TMOD_MAX_ADCS);
+
+/**
+ * Context of the current backend, nullptr for the dummy implementation.
+ */
+void* tmodGetReadAdcBackendContext();
+
+/**
+ * Simulate the duration of a bus transaction: every tmodReadAdc() call
+ * sleeps that long, whatever the backend.
+ * @param microseconds: latency of a read, 0 to disable.
+ */
+void tmodSetBusLatency(uint32_t microseconds);
+
+/**
+ * Clock of the simulator, used to wait for the bus and to seed the dummy
+ * random values. Passing nullptr restores the real clock.
+ */
+void tmodSetClock(Clock* clock);
+
 #endif // LIBTMOD_LIBRARY_H
@@ -0,0 +1,212 @@
+// STD includes
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+// Third parties includes
+#include <boost/format.hpp>
+
+// Local includes
+#include "ChannelAggregator.h"
+
+using namespace std;
+
+namespace
+{
+//! Independent accumulators of a reduction.
+constexpr size_t LANES = 8;
+
+struct Reduction
+{
+    float min;
+    float max;
+    float sum;
+};
+
+/**
+ * Minimum, maximum and sum of the values, in LANES interleaved lanes: the
+ * lanes do not depend on each other, which lets the compiler vectorise the
+ * loop without reordering the additions of a lane.
+ */
+Reduction reduce(const float* values, size_t count)
+{
+    float mins[LANES];
+    float maxs[LANES];
+    float sums[LANES];
+    for (size_t lane = 0; lane < LANES; lane++)
+    {
+        mins[lane] = numeric_limits<float>::infinity();
+        maxs[lane] = -numeric_limits<float>::infinity();
+        sums[lane] = 0.f;
+    }
+
+    size_t i = 0;
+    for (; i + LANES <= count; i += LANES)
+        for (size_t lane = 0; lane < LANES; lane++)
+        {
+            const float value = values[i + lane];
+            mins[lane] = value < mins[lane] ? value : mins[lane];
+            maxs[lane] = value > maxs[lane] ? value : maxs[lane];
+            sums[lane] += value;
+        }
+    for (size_t lane = 0; i < count; i++, lane++)
+    {
+        mins[lane] = min(mins[lane], values[i]);
+        maxs[lane] = max(maxs[lane], values[i]);
+        sums[lane] += values[i];
+    }
+
+    Reduction reduction = {mins[0], maxs[0], sums[0]};
+    for (size_t lane = 1; lane < LANES; lane++)
+    {
+        reduction.min = min(reduction.min, mins[lane]);
+        reduction.max = max(reduction.max, maxs[lane]);
+        reduction.sum += sums[lane];
+    }
+    return reduction;
+}
+
+bool isValidName(const string& name)
+{
+    const auto isNameChar = [](char c) {
+        return isalnum((unsigned char)c) || c == '.' || c == '_' || c == '-';
+    };
+    return !name.empty() && isalnum((unsigned char)name[0]) &&
+           all_of(name.begin(), name.end(), isNameChar);
+}
+} // namespace
+
+void ChannelAggregator::addGroup(ChannelGroup group)
+{
+    if (!isValidName(group.name))
+        throw invalid_argument(
+            str(boost::format("Invalid group name: \"%1%\".") % group.name));
+    for (const auto& other : groups)
+        if (other.name == group.name)
+            throw invalid_argument(
+                str(boost::format("Group %1% already exists.") % group.name));
+    if ((group.metrics & AGGREGATE_ALL) == 0)
+        throw invalid_argument(
+            str(boost::format("No metric selected for group %1%.") %
+                group.name));
+    for (uint16_t hardwareId : group.hardwareIds)
+        if (!binary_search(hardwareIds.begin(), hardwareIds.end(), hardwareId))
+            throw invalid_argument(
+                str(boost::format("No Temperature has previously been added "
+                                  "to the hardware address %1%.") %
+                    hardwareId));
+
+    sort(group.hardwareIds.begin(), group.hardwareIds.end());
+    group.hardwareIds.erase(
+        unique(group.hardwareIds.begin(), group.hardwareIds.end()),
+        group.hardwareIds.end());
+    groups.push_back(move(group));
+    groupChannels.emplace_back();
+    aggregates.emplace_back();
+    bindGroup(groups.size() - 1);
+}
+
+void ChannelAggregator::removeGroup(const string& name)
+{
+    for (size_t group = 0; group < groups.size(); group++)
+        if (groups[group].name == name)
+        {
+            groups.erase(groups.begin() + (ptrdiff_t)group);
+            groupChannels.erase(groupChannels.begin() + (ptrdiff_t)group);
+            aggregates.erase(aggregates.begin() + (ptrdiff_t)group);
+            return;
+        }
+    throw invalid_argument(str(boost::format("No group named %1%.") % name));
+}
+
+void ChannelAggregator::bind(const vector<uint16_t>& newHardwareIds)
+{
+    hardwareIds = newHardwareIds;
+    temperatures.assign(hardwareIds.size(), 0.f);
+    faults.assign(hardwareIds.size(), 0);
+    healthy.resize(hardwareIds.size());
+    for (size_t group = 0; group < groups.size(); group++)
+        bindGroup(group);
+}
+
+void ChannelAggregator::record(size_t channel, float temperature,
+                               bool faulted)
+{
+    temperatures[channel] = temperature;
+    faults[channel] = faulted;
+}
+
+void ChannelAggregator::aggregate()
+{
+    for (size_t group = 0; group < groups.size(); group++)
+    {
+        const vector<uint32_t>& channels = groupChannels[group];
+        GroupAggregate& result = aggregates[group];
+        result.channels = (uint16_t)channels.size();
+
+        size_t count = 0;
+        for (uint32_t channel : channels)
+            if (!faults[channel])
+                healthy[count++] = temperatures[channel];
+        result.faults = (uint16_t)(channels.size() - count);
+        if (count == 0)
+        {
+            result.coldest = result.hottest = UINT16_MAX;
+            result.min = result.max = result.mean = result.spread = NAN;
+            continue;
+        }
+
+        const Reduction reduction = reduce(healthy.data(), count);
+        result.min = reduction.min;
+        result.max = reduction.max;
+        result.mean = reduction.sum / (float)count;
+        result.spread = reduction.max - reduction.min;
+        result.coldest = result.hottest = UINT16_MAX;
+        for (uint32_t channel : channels)
+        {
+            if (faults[channel])
+                continue;
+            if (result.coldest == UINT16_MAX &&
+                temperatures[channel] == reduction.min)
+                result.coldest = hardwareIds[channel];
+            if (result.hottest == UINT16_MAX &&
+                temperatures[channel] == reduction.max)
+                result.hottest = hardwareIds[channel];
+        }
+    }
+}
+
+const vector<ChannelGroup>& ChannelAggregator::getGroups() const
+{
+    return groups;
+}
+
+const vector<GroupAggregate>& ChannelAggregator::getAggregates() const
+{
+    return aggregates;
+}
+
+void ChannelAggregator::bindGroup(size_t group)
+{
+    const ChannelGroup& config = groups[group];
+    vector<uint32_t>& channels = groupChannels[group];
+    channels.clear();
+    if (config.hardwareIds.empty())
+    {
+        for (uint32_t channel = 0; channel < hardwareIds.size(); channel++)
+            channels.push_back(channel);
+        return;
+    }
+
+    // Removed sensors are left out, until they are added again.
+    for (uint16_t hardwareId : config.hardwareIds)
+    {
+        const auto it =
+            lower_bound(hardwareIds.begin(), hardwareIds.end(), hardwareId);
+        if (it != hardwareIds.end() && *it == hardwareId)
+            channels.push_back((uint32_t)(it - hardwareIds.begin()));
+    }
+}
@@ -0,0 +1,122 @@
+#ifndef TAKING_THE_TEMPERATURE_CHANNELAGGREGATOR_H
+#define TAKING_THE_TEMPERATURE_CHANNELAGGREGATOR_H
+
+// STD includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+enum AggregateMetric : uint8_t
+{
+    AGGREGATE_MIN = 1,     /**< Coldest channel and its temperature */
+    AGGREGATE_MAX = 2,     /**< Hottest channel and its temperature */
+    AGGREGATE_MEAN = 4,    /**< Mean temperature */
+    AGGREGATE_SPREAD = 8,  /**< Hottest minus coldest temperature */
+    AGGREGATE_FAULTS = 16, /**< Count of faulted channels */
+    AGGREGATE_ALL = 31     /**< All of the above */
+};
+
+/**
+ * @brief Channels aggregated together, e.g. the sensors of a crate slot.
+ */
+struct ChannelGroup
+{
+    //! Name of the group in the summaries: letters, digits, '.', '_' and
+    //! '-', starting with a letter or a digit.
+    string name;
+    //! Hardware Ids of the channels, all the sensors if empty.
+    vector<uint16_t> hardwareIds;
+    //! AggregateMetric flags.
+    uint8_t metrics = AGGREGATE_ALL;
+};
+
+/**
+ * @brief Aggregates of a group over one sweep.
+ * Faulted channels are counted, and left out of the other figures. Without
+ * any healthy channel, the temperatures are NaN and the channels
+ * UINT16_MAX.
+ */
+struct GroupAggregate
+{
+    //! Channels of the group, faulted ones included.
+    uint16_t channels = 0;
+    uint16_t faults = 0;
+    //! Hardware Id of the coldest channel, the first one on a tie.
+    uint16_t coldest = UINT16_MAX;
+    //! Hardware Id of the hottest channel, the first one on a tie.
+    uint16_t hottest = UINT16_MAX;
+    float min = 0.f;
+    float max = 0.f;
+    float mean = 0.f;
+    float spread = 0.f;
+};
+
+/**
+ * @brief Per-sweep aggregates over groups of channels.
+ * The temperatures of a sweep are recorded into a dense array, indexed like
+ * the sensors. Each group gathers its healthy channels into a contiguous
+ * buffer, reduced in independent lanes so that the compiler can keep them
+ * in vector registers. Once the channels are bound, aggregating does not
+ * allocate.
+ */
+class ChannelAggregator
+{
+public:
+    /**
+     * @brief Add a group.
+     * @throw invalid_argument: if the name is not valid or already used, if
+     * a channel is not bound, or if no metric is selected.
+     */
+    void addGroup(ChannelGroup group);
+
+    /**
+     * @brief Remove a group.
+     * @throw invalid_argument: if no group has this name.
+     */
+    void removeGroup(const string& name);
+
+    /**
+     * @brief Set the channels of the sweeps.
+     * Channels no longer present are left out of their groups.
+     * @param hardwareIds: hardware Id of each channel, sorted.
+     */
+    void bind(const vector<uint16_t>& hardwareIds);
+
+    /**
+     * @brief Record the temperature of a channel for the current sweep.
+     * @param channel: index of the channel, in the order of bind().
+     * @param temperature: converted value, ignored if faulted.
+     * @param faulted: whether the channel failed to read.
+     */
+    void record(size_t channel, float temperature, bool faulted);
+
+    /**
+     * @brief Compute the aggregates of every group from the recorded sweep.
+     */
+    void aggregate();
+
+    [[nodiscard]] const vector<ChannelGroup>& getGroups() const;
+
+    /**
+     * @brief Get the aggregates of the last sweep, in the order of the groups.
+     */
+    [[nodiscard]] const vector<GroupAggregate>& getAggregates() const;
+
+private:
+    vector<ChannelGroup> groups;
+    /// Channels of each group, as indices in the recorded arrays.
+    vector<vector<uint32_t>> groupChannels;
+    vector<GroupAggregate> aggregates;
+
+    vector<uint16_t> hardwareIds;
+    vector<float> temperatures;
+    vector<uint8_t> faults;
+    /// Healthy temperatures of the group being reduced.
+    vector<float> healthy;
+
+    void bindGroup(size_t group);
+};
+
+#endif // TAKING_THE_TEMPERATURE_CHANNELAGGREGATOR_H
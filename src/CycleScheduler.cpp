@@ -0,0 +1,40 @@
+// STD includes
+#include <stdexcept>
+
+// Local includes
+#include "CycleScheduler.h"
+
+using namespace std;
+
+CycleScheduler::CycleScheduler(Clock& clock, chrono::nanoseconds period)
+    : clock(clock), period(period)
+{
+    if (period <= chrono::nanoseconds::zero())
+        throw invalid_argument("Cycle period should be strictly positive.");
+}
+
+void CycleScheduler::run(uint64_t cycles, const function<void()>& cycle)
+{
+    auto deadline = clock.steadyNow();
+    for (uint64_t i = 0; i < cycles; i++)
+    {
+        cycle();
+        cycleCount++;
+        if (i + 1 == cycles)
+            break;
+
+        deadline += period;
+        const auto now = clock.steadyNow();
+        if (now > deadline)
+        {
+            // Start at once, rather than catching up in a burst.
+            overrunCount++;
+            deadline = now;
+        }
+        clock.sleepUntil(deadline);
+    }
+}
+
+uint64_t CycleScheduler::getOverrunCount() const { return overrunCount; }
+
+uint64_t CycleScheduler::getCycleCount() const { return cycleCount; }
@@ -0,0 +1,55 @@
+#ifndef TAKING_THE_TEMPERATURE_CYCLESCHEDULER_H
+#define TAKING_THE_TEMPERATURE_CYCLESCHEDULER_H
+
+// STD includes
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+// Local includes
+#include "Clock.h"
+
+using namespace std;
+
+/**
+ * @brief Fixed-rate trigger of the acquisition cycles.
+ * Cycle k is started period * k after the first one, so that the cycles do
+ * not drift. A cycle lasting longer than the period is an overrun: the next
+ * cycle starts at once, and the schedule restarts from it.
+ */
+class CycleScheduler
+{
+public:
+    /**
+     * @param clock: clock to wait on, not owned.
+     * @param period: time between the starts of two cycles.
+     * @throw invalid_argument: if the period is not strictly positive.
+     */
+    CycleScheduler(Clock& clock, chrono::nanoseconds period);
+
+    /**
+     * @brief Run a number of cycles.
+     * Returns right after the last cycle. A new run starts a new schedule.
+     * @param cycles: number of cycles to run.
+     * @param cycle: task of a cycle, e.g. producing a report.
+     */
+    void run(uint64_t cycles, const function<void()>& cycle);
+
+    /**
+     * @brief Get the number of cycles which lasted longer than the period.
+     */
+    [[nodiscard]] uint64_t getOverrunCount() const;
+
+    /**
+     * @brief Get the number of cycles run.
+     */
+    [[nodiscard]] uint64_t getCycleCount() const;
+
+private:
+    Clock& clock;
+    chrono::nanoseconds period;
+    uint64_t overrunCount = 0;
+    uint64_t cycleCount = 0;
+};
+
+#endif // TAKING_THE_TEMPERATURE_CYCLESCHEDULER_H
@@ -0,0 +1,38 @@
+#ifndef TAKING_THE_TEMPERATURE_REPORTFORMAT_H
+#define TAKING_THE_TEMPERATURE_REPORTFORMAT_H
+
+// STD includes
+#include <charconv>
+#include <cmath>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * Append a number to a report: shortest round-trip representation for the
+ * floats, with the YAML spelling of infinities and NaN.
+ * Internal to the library, shared by the writers of report text.
+ */
+template <typename T>
+void appendNumber(string& report, T value)
+{
+    if constexpr (is_floating_point_v<T>)
+    {
+        if (isnan(value))
+        {
+            report += ".nan";
+            return;
+        }
+        if (isinf(value))
+        {
+            report += value > 0 ? ".inf" : "-.inf";
+            return;
+        }
+    }
+    char number[32];
+    const auto result = to_chars(number, number + sizeof(number), value);
+    report.append(number, result.ptr);
+}
+
+#endif // TAKING_THE_TEMPERATURE_REPORTFORMAT_H
@@ -0,0 +1,460 @@
+// STD includes
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+// Third parties includes
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/date_time/c_local_time_adjustor.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/format.hpp>
+#include <boost/iostreams/device/file.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+// Local includes
+#include "ReportFormat.h"
+#include "ReportMerger.h"
+#include "ReportReader.h"
+#include "StreamProtocol.h"
+
+using namespace boost::posix_time;
+using namespace std;
+
+namespace io = boost::iostreams;
+
+namespace
+{
+//! Size of the reads from the sources.
+constexpr size_t CHUNK_SIZE = 64 * 1024;
+//! Key of an exhausted source, after any time stamp.
+constexpr int64_t EXHAUSTED = INT64_MAX;
+//! Largest SWEEP payload: every channel of the crate.
+constexpr uint32_t MAX_SWEEP_SIZE =
+    1 + 8 + 8 + 2 + UINT16_MAX * sizeof(ChannelReading);
+
+bool isValidName(const string& name)
+{
+    const auto isNameChar = [](char c) {
+        return isalnum((unsigned char)c) || c == '.' || c == '_' || c == '-';
+    };
+    return !name.empty() && isalnum((unsigned char)name[0]) &&
+           all_of(name.begin(), name.end(), isNameChar);
+}
+} // namespace
+
+ReportSource::ReportSource(string name, bool follow)
+    : name(std::move(name)), follow(follow)
+{
+    if (!isValidName(this->name))
+        throw invalid_argument(
+            str(boost::format("Invalid source name: \"%1%\".") % this->name));
+}
+
+void ReportSource::stopFollowing() { follow = false; }
+
+const string& ReportSource::getName() const { return name; }
+
+YamlReportSource::YamlReportSource(const string& path, string name,
+                                   bool follow)
+    : ReportSource(std::move(name), follow), path(path)
+{
+    const bool gzip = boost::algorithm::ends_with(path, ".gz");
+    const bool zstd = boost::algorithm::ends_with(path, ".zst");
+    if ((gzip || zstd) && follow)
+        throw invalid_argument(
+            str(boost::format("Compressed report %1% cannot be followed.") %
+                path));
+
+    auto file = make_unique<ifstream>(path, ios::binary);
+    if (!file->is_open())
+        throw invalid_argument(
+            str(boost::format("Impossible to access %1%.") % path));
+    if (gzip || zstd)
+    {
+        file.reset();
+        auto stream = make_unique<io::filtering_istream>();
+        if (gzip)
+            stream->push(io::gzip_decompressor());
+        else
+            stream->push(io::zstd_decompressor());
+        stream->push(io::file_source(path, ios::binary));
+        input = std::move(stream);
+    }
+    else
+        input = std::move(file);
+}
+
+MergeStatus YamlReportSource::next(MergeCycle& cycle)
+{
+    while (true)
+    {
+        size_t lineEnd;
+        while ((lineEnd = buffer.find('\n', offset)) != string::npos)
+        {
+            const char* line = buffer.data() + offset;
+            const size_t size = lineEnd - offset;
+            offset = lineEnd + 1;
+            if (size == 0)
+                continue;
+            if (line[0] != ' ')
+            {
+                // A new cycle completes the previous one.
+                const bool complete = inCycle;
+                if (complete)
+                    swap(cycle, current);
+                startCycle(line, size);
+                if (complete)
+                    return MERGE_CYCLE_READY;
+            }
+            else if (inCycle)
+                appendEntry(line, size);
+            else
+                throw runtime_error(
+                    str(boost::format("Sensor entry before any time stamp "
+                                      "in %1%.") %
+                        path));
+        }
+        buffer.erase(0, offset);
+        offset = 0;
+
+        if (readChunk())
+            continue;
+        if (follow)
+            return MERGE_NEED_MORE_DATA;
+        // A last line without end of line.
+        if (!buffer.empty())
+        {
+            buffer += '\n';
+            continue;
+        }
+        if (!inCycle)
+            return MERGE_END_OF_STREAM;
+        inCycle = false;
+        swap(cycle, current);
+        return MERGE_CYCLE_READY;
+    }
+}
+
+bool YamlReportSource::readChunk()
+{
+    const size_t size = buffer.size();
+    buffer.resize(size + CHUNK_SIZE);
+    input->read(&buffer[size], CHUNK_SIZE);
+    const auto count = (size_t)input->gcount();
+    buffer.resize(size + count);
+    // The end of a followed file moves as it is written.
+    if (input->eof())
+        input->clear();
+    return count > 0;
+}
+
+void YamlReportSource::startCycle(const char* line, size_t size)
+{
+    // "2021-Feb-09 20:55:51:", or "...: {}" for a cycle without sensors.
+    const char* colon = static_cast<const char*>(memchr(line, ':', size));
+    while (colon != nullptr && colon + 1 < line + size && colon[1] != ' ')
+        colon = static_cast<const char*>(
+            memchr(colon + 1, ':', (size_t)(line + size - colon - 1)));
+    const size_t timestampSize =
+        colon == nullptr ? size : (size_t)(colon - line);
+    const int64_t timestampMs =
+        ReportIndex::parseTimestamp(line, timestampSize);
+    if (timestampMs < 0)
+        throw runtime_error(
+            str(boost::format("Invalid time stamp in %1%: \"%2%\".") % path %
+                string(line, size)));
+
+    current.timestampMs = timestampMs;
+    current.timestamp.assign(line, timestampSize);
+    current.entries.clear();
+    inCycle = true;
+}
+
+void YamlReportSource::appendEntry(const char* line, size_t size)
+{
+    // Sensor keys are indented by two spaces, their fields by four.
+    if (size > 2 && line[1] == ' ' && line[2] != ' ')
+    {
+        if (size == 4 && memcmp(line, "  {}", 4) == 0)
+            return;
+        size_t key = 2;
+        if (line[2] == '"' || line[2] == '\'')
+            key++;
+        current.entries.append(line, key);
+        current.entries += name;
+        current.entries += '/';
+        current.entries.append(line + key, size - key);
+    }
+    else
+        current.entries.append(line, size);
+    current.entries += '\n';
+}
+
+SweepCaptureSource::SweepCaptureSource(const string& path, string name,
+                                       bool follow)
+    : ReportSource(std::move(name), follow), path(path)
+{
+    auto file = make_unique<ifstream>(path, ios::binary);
+    if (!file->is_open())
+        throw invalid_argument(
+            str(boost::format("Impossible to access %1%.") % path));
+    input = std::move(file);
+}
+
+MergeStatus SweepCaptureSource::next(MergeCycle& cycle)
+{
+    while (true)
+    {
+        const size_t available = buffer.size() - offset;
+        if (available >= STREAM_LENGTH_SIZE)
+        {
+            uint32_t length;
+            memcpy(&length, buffer.data() + offset, STREAM_LENGTH_SIZE);
+            if (length > MAX_SWEEP_SIZE)
+                throw runtime_error(
+                    str(boost::format("Invalid frame length in %1%: %2%.") %
+                        path % length));
+            if (available >= STREAM_LENGTH_SIZE + length)
+            {
+                const char* payload =
+                    buffer.data() + offset + STREAM_LENGTH_SIZE;
+                if (!decodeSweep(payload, length, sweep))
+                    throw runtime_error(
+                        str(boost::format("Invalid sweep frame in %1%.") %
+                            path));
+                offset += STREAM_LENGTH_SIZE + length;
+                render(cycle);
+                return MERGE_CYCLE_READY;
+            }
+        }
+        buffer.erase(0, offset);
+        offset = 0;
+
+        const size_t size = buffer.size();
+        buffer.resize(size + CHUNK_SIZE);
+        input->read(&buffer[size], CHUNK_SIZE);
+        const auto count = (size_t)input->gcount();
+        buffer.resize(size + count);
+        if (input->eof())
+            input->clear();
+        if (count > 0)
+            continue;
+        if (follow)
+            return MERGE_NEED_MORE_DATA;
+        buffer.clear();
+        return MERGE_END_OF_STREAM;
+    }
+}
+
+void SweepCaptureSource::render(MergeCycle& cycle) const
+{
+    // Report time stamps are local, to the millisecond.
+    const int64_t timestampMs = sweep.timestampNs / 1000000;
+    const ptime utc = from_time_t(timestampMs / 1000) +
+                      milliseconds(timestampMs % 1000);
+    const ptime local =
+        boost::date_time::c_local_adjustor<ptime>::utc_to_local(utc);
+    cycle.timestampMs =
+        (local - ptime(boost::gregorian::date(1970, 1, 1))).total_milliseconds();
+    cycle.timestamp = to_simple_string(local);
+
+    cycle.entries.clear();
+    for (const ChannelReading& reading : sweep.readings)
+    {
+        cycle.entries += "  ";
+        cycle.entries += name;
+        cycle.entries += '/';
+        appendNumber(cycle.entries, reading.hardwareId);
+        cycle.entries += ":\n    Hardware Id: ";
+        appendNumber(cycle.entries, reading.hardwareId);
+        cycle.entries += "\n    Adc value: ";
+        appendNumber(cycle.entries, reading.adcValue);
+        cycle.entries += "\n    Current time: ";
+        cycle.entries += cycle.timestamp;
+        cycle.entries += "\n    Temperature: ";
+        appendNumber(cycle.entries, reading.temperature);
+        cycle.entries += "\n    Min temperature: ";
+        appendNumber(cycle.entries, reading.minTemperature);
+        cycle.entries += "\n    Max temperature: ";
+        appendNumber(cycle.entries, reading.maxTemperature);
+        cycle.entries += '\n';
+    }
+}
+
+LoserTree::LoserTree(vector<int64_t> keys) : keys(std::move(keys))
+{
+    if (this->keys.empty())
+        throw invalid_argument("A loser tree needs at least one leaf.");
+    // Leaf i sits below node (i + k) / 2, node 0 holds the winner. Playing
+    // every leaf in turn fills an empty node with the first leaf reaching
+    // it, and the other one plays against it.
+    nodes.assign(this->keys.size(), SIZE_MAX);
+    for (size_t leaf = 0; leaf < this->keys.size(); leaf++)
+    {
+        size_t winner = leaf;
+        size_t node = (leaf + this->keys.size()) / 2;
+        for (; node > 0; node /= 2)
+        {
+            if (nodes[node] == SIZE_MAX)
+            {
+                nodes[node] = winner;
+                break;
+            }
+            if (beats(nodes[node], winner))
+                swap(nodes[node], winner);
+        }
+        if (node == 0)
+            nodes[0] = winner;
+    }
+}
+
+size_t LoserTree::getWinner() const { return nodes[0]; }
+
+int64_t LoserTree::getWinnerKey() const { return keys[nodes[0]]; }
+
+void LoserTree::replaceWinnerKey(int64_t key)
+{
+    keys[nodes[0]] = key;
+    replay(nodes[0]);
+}
+
+bool LoserTree::beats(size_t a, size_t b) const
+{
+    return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+}
+
+void LoserTree::replay(size_t leaf)
+{
+    size_t winner = leaf;
+    for (size_t node = (leaf + keys.size()) / 2; node > 0; node /= 2)
+        if (beats(nodes[node], winner))
+            swap(nodes[node], winner);
+    nodes[0] = winner;
+}
+
+ReportMerger::ReportMerger(vector<unique_ptr<ReportSource>> sources,
+                           ostream& output, chrono::milliseconds tolerance)
+    : sources(std::move(sources)), output(output),
+      toleranceMs(tolerance.count())
+{
+    if (this->sources.empty())
+        throw invalid_argument("No report to merge.");
+    if (toleranceMs < 0)
+        throw invalid_argument(
+            str(boost::format("Invalid tolerance: %1% ms.") % toleranceMs));
+    for (size_t i = 0; i < this->sources.size(); i++)
+        for (size_t j = 0; j < i; j++)
+            if (this->sources[i]->getName() == this->sources[j]->getName())
+                throw invalid_argument(
+                    str(boost::format("Duplicated source name: %1%.") %
+                        this->sources[i]->getName()));
+    heads.resize(this->sources.size());
+    grouped.assign(this->sources.size(), false);
+}
+
+MergeStatus ReportMerger::step()
+{
+    if (tree == nullptr && start() == MERGE_NEED_MORE_DATA)
+        return MERGE_NEED_MORE_DATA;
+
+    while (true)
+    {
+        // The source of the last cycle taken: its next cycle decides
+        // whether the combined cycle is complete.
+        if (pendingSource != NONE)
+        {
+            int64_t key = EXHAUSTED;
+            if (readHead(pendingSource, key) == MERGE_NEED_MORE_DATA)
+                return MERGE_NEED_MORE_DATA;
+            pendingSource = NONE;
+            tree->replaceWinnerKey(key);
+        }
+
+        const size_t source = tree->getWinner();
+        const int64_t key = tree->getWinnerKey();
+        if (grouping &&
+            (key == EXHAUSTED || key - groupStartMs > toleranceMs ||
+             grouped[source]))
+        {
+            writeGroup();
+            return MERGE_CYCLE_READY;
+        }
+        if (key == EXHAUSTED)
+            return MERGE_END_OF_STREAM;
+
+        if (!grouping)
+        {
+            grouping = true;
+            groupStartMs = key;
+            group = heads[source].timestamp;
+            group += ":\n";
+            groupHeaderSize = group.size();
+        }
+        group += heads[source].entries;
+        grouped[source] = true;
+        pendingSource = source;
+        sourceCycleCount++;
+    }
+}
+
+MergeStatus ReportMerger::run()
+{
+    MergeStatus status;
+    while ((status = step()) == MERGE_CYCLE_READY)
+        ;
+    return status;
+}
+
+ReportSource& ReportMerger::getSource(size_t source)
+{
+    return *sources.at(source);
+}
+
+uint64_t ReportMerger::getCycleCount() const { return cycleCount; }
+
+uint64_t ReportMerger::getSourceCycleCount() const { return sourceCycleCount; }
+
+MergeStatus ReportMerger::readHead(size_t source, int64_t& key)
+{
+    const MergeStatus status = sources[source]->next(heads[source]);
+    if (status == MERGE_CYCLE_READY)
+        key = heads[source].timestampMs;
+    else if (status == MERGE_END_OF_STREAM)
+        key = EXHAUSTED;
+    return status;
+}
+
+MergeStatus ReportMerger::start()
+{
+    // The tree is built once every source has its first cycle, or ended.
+    vector<int64_t> keys(sources.size(), EXHAUSTED);
+    bool waiting = false;
+    for (size_t source = 0; source < sources.size(); source++)
+    {
+        if (heads[source].timestamp.empty() &&
+            readHead(source, keys[source]) == MERGE_NEED_MORE_DATA)
+            waiting = true;
+        else if (!heads[source].timestamp.empty())
+            keys[source] = heads[source].timestampMs;
+    }
+    if (waiting)
+        return MERGE_NEED_MORE_DATA;
+    tree = make_unique<LoserTree>(std::move(keys));
+    return MERGE_CYCLE_READY;
+}
+
+void ReportMerger::writeGroup()
+{
+    // A source joins a combined cycle at most once.
+    fill(grouped.begin(), grouped.end(), false);
+    grouping = false;
+    if (group.size() == groupHeaderSize)
+        group += "  {}\n";
+    output.write(group.data(), (streamsize)group.size());
+    output.flush();
+    cycleCount++;
+}
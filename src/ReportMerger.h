@@ -0,0 +1,250 @@
+#ifndef TAKING_THE_TEMPERATURE_REPORTMERGER_H
+#define TAKING_THE_TEMPERATURE_REPORTMERGER_H
+
+// STD includes
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Local includes
+#include "SweepPublisher.h"
+
+using namespace std;
+
+enum MergeStatus
+{
+    MERGE_CYCLE_READY = 0,    /**< A cycle was produced */
+    MERGE_NEED_MORE_DATA = 1, /**< Waiting for a followed source to grow */
+    MERGE_END_OF_STREAM = 2   /**< Every source is exhausted */
+};
+
+/**
+ * @brief Cycle read from a source, with its sensor entries rendered as YAML.
+ */
+struct MergeCycle
+{
+    //! Time stamp, as returned by ReportIndex::parseTimestamp().
+    int64_t timestampMs = 0;
+    //! Time stamp as written in the report.
+    string timestamp;
+    //! Sensor entries, indented by two spaces, keys prefixed by the source.
+    string entries;
+};
+
+/**
+ * @brief Stream of cycles merged by ReportMerger.
+ * The data is read in chunks, only the cycle in progress is kept in memory.
+ * In follow mode, the end of the data is a cycle still being written: the
+ * last cycle is only complete once the next one starts.
+ */
+class ReportSource
+{
+public:
+    /**
+     * @param name: prefix of the sensor keys, e.g. crate1 for
+     * "crate1/2-PT1000". Letters, digits, '.', '_' and '-', starting with a
+     * letter or a digit.
+     * @param follow: tail the source, waiting for more data at its end.
+     * @throw invalid_argument: if the name is not valid.
+     */
+    ReportSource(string name, bool follow);
+
+    virtual ~ReportSource() = default;
+
+    /**
+     * @brief Read the next complete cycle.
+     * Time stamps of a source are expected to be non-decreasing.
+     * @param cycle: filled if MERGE_CYCLE_READY is returned.
+     * @return MERGE_NEED_MORE_DATA in follow mode when no complete cycle is
+     * available yet, MERGE_END_OF_STREAM at the end of a source not
+     * followed.
+     * @throw runtime_error: if the data is not valid.
+     */
+    virtual MergeStatus next(MergeCycle& cycle) = 0;
+
+    /**
+     * @brief Stop following, the end of the data becomes the end of the
+     * stream.
+     */
+    void stopFollowing();
+
+    [[nodiscard]] const string& getName() const;
+
+protected:
+    string name;
+    bool follow;
+};
+
+/**
+ * @brief Report in the YAML format of VmeSystem.
+ * Reports compressed by ReportWriter are read in batch mode if their path
+ * ends in ".gz" or ".zst".
+ */
+class YamlReportSource : public ReportSource
+{
+public:
+    /**
+     * @throw invalid_argument: if the report cannot be opened, or if a
+     * compressed report is followed.
+     */
+    YamlReportSource(const string& path, string name, bool follow = false);
+
+    MergeStatus next(MergeCycle& cycle) override;
+
+private:
+    string path;
+    unique_ptr<istream> input;
+    string buffer;
+    size_t offset = 0;
+    MergeCycle current;
+    bool inCycle = false;
+
+    bool readChunk();
+    void startCycle(const char* line, size_t size);
+    void appendEntry(const char* line, size_t size);
+};
+
+/**
+ * @brief Capture of a live stream: SWEEP frames of StreamProtocol.h, as
+ * received by a StreamServer client. A truncated frame at the end of a
+ * source not followed is ignored.
+ * The frames only carry the readings: their entries are keyed
+ * "<source>/<hardware Id>" and hold Hardware Id, Adc value, Current time,
+ * Temperature, Min temperature and Max temperature. The Name, Sensor type,
+ * Scaling factor and Offset of the YAML reports are left out rather than
+ * made up.
+ */
+class SweepCaptureSource : public ReportSource
+{
+public:
+    /**
+     * @throw invalid_argument: if the capture cannot be opened.
+     */
+    SweepCaptureSource(const string& path, string name, bool follow = false);
+
+    MergeStatus next(MergeCycle& cycle) override;
+
+private:
+    string path;
+    unique_ptr<istream> input;
+    string buffer;
+    size_t offset = 0;
+    SweepSnapshot sweep;
+
+    void render(MergeCycle& cycle) const;
+};
+
+/**
+ * @brief Tournament tree of losers over the heads of k sorted streams.
+ * Node 0 holds the winner, the smallest key, ties going to the lowest
+ * leaf. Replacing the key of the winner replays only its path: log2(k)
+ * comparisons.
+ */
+class LoserTree
+{
+public:
+    /**
+     * @param keys: initial key of each leaf, at least one.
+     * @throw invalid_argument: if there is no leaf.
+     */
+    explicit LoserTree(vector<int64_t> keys);
+
+    [[nodiscard]] size_t getWinner() const;
+
+    [[nodiscard]] int64_t getWinnerKey() const;
+
+    /**
+     * @brief Replace the key of the winner and find the new one.
+     */
+    void replaceWinnerKey(int64_t key);
+
+private:
+    vector<int64_t> keys;
+    vector<size_t> nodes;
+
+    [[nodiscard]] bool beats(size_t a, size_t b) const;
+    void replay(size_t leaf);
+};
+
+/**
+ * @brief Time-ordered merge of several report streams into one.
+ * Cycles of all the sources are merged by time stamp with a loser tree.
+ * Consecutive cycles of the merged order are combined into a single cycle
+ * as long as they are within the tolerance of the first one and come from
+ * different sources. A combined cycle is written as a report entry with
+ * the time stamp of its first cycle, holding the sensor entries of every
+ * source, and the stream is flushed after each of them.
+ *
+ * Memory is bounded by one pending cycle per source, whatever the size of
+ * the inputs. In follow mode, the merge stops with MERGE_NEED_MORE_DATA
+ * until every source has a cycle past the current one, so a silent source
+ * holds the others back.
+ */
+class ReportMerger
+{
+public:
+    /**
+     * @param sources: streams to merge, at least one.
+     * @param output: combined stream.
+     * @param tolerance: largest time difference between the cycles combined.
+     * @throw invalid_argument: if there is no source, two sources have the
+     * same name, or the tolerance is negative.
+     */
+    ReportMerger(vector<unique_ptr<ReportSource>> sources, ostream& output,
+                 chrono::milliseconds tolerance = chrono::milliseconds(0));
+
+    /**
+     * @brief Write the next combined cycle, if possible.
+     * @return MERGE_CYCLE_READY once a cycle is written.
+     */
+    MergeStatus step();
+
+    /**
+     * @brief Write every combined cycle available.
+     * @return MERGE_NEED_MORE_DATA or MERGE_END_OF_STREAM.
+     */
+    MergeStatus run();
+
+    [[nodiscard]] ReportSource& getSource(size_t source);
+
+    /**
+     * @brief Get the number of combined cycles written.
+     */
+    [[nodiscard]] uint64_t getCycleCount() const;
+
+    /**
+     * @brief Get the number of source cycles written.
+     */
+    [[nodiscard]] uint64_t getSourceCycleCount() const;
+
+private:
+    static constexpr size_t NONE = SIZE_MAX;
+
+    vector<unique_ptr<ReportSource>> sources;
+    ostream& output;
+    int64_t toleranceMs;
+    /// Next cycle of each source.
+    vector<MergeCycle> heads;
+    unique_ptr<LoserTree> tree;
+    /// Source whose head was taken and must be read again.
+    size_t pendingSource = NONE;
+
+    /// Combined cycle in progress.
+    bool grouping = false;
+    int64_t groupStartMs = 0;
+    vector<bool> grouped;
+    string group;
+    size_t groupHeaderSize = 0;
+
+    uint64_t cycleCount = 0;
+    uint64_t sourceCycleCount = 0;
+
+    MergeStatus readHead(size_t source, int64_t& key);
+    MergeStatus start();
+    void writeGroup();
+};
+
+#endif // TAKING_THE_TEMPERATURE_REPORTMERGER_H
@@ -0,0 +1,508 @@
+// C includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// STD includes
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+// Third parties includes
+#include <boost/format.hpp>
+
+// Local includes
+#include "ReportReader.h"
+
+using namespace std;
+
+namespace
+{
+constexpr char INDEX_MAGIC[4] = {'T', 'T', 'R', 'I'};
+constexpr uint16_t INDEX_VERSION = 1;
+//! Number of leading bytes hashed to identify a report.
+constexpr size_t FINGERPRINT_SIZE = 256;
+
+template <typename T>
+void writeValue(ofstream& file, const T& value)
+{
+    file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void readValue(ifstream& file, T& value, const string& path)
+{
+    if (!file.read(reinterpret_cast<char*>(&value), sizeof(T)))
+    {
+        const string errorMessage =
+            str(boost::format("Index %1% is truncated.") % path);
+        throw runtime_error(errorMessage);
+    }
+}
+
+size_t indentation(const char* line, const char* end)
+{
+    const char* c = line;
+    while (c < end && *c == ' ')
+        c++;
+    return c - line;
+}
+
+/**
+ * Key of a "key:" line, without the quotes yaml-cpp may add.
+ */
+string keyOf(const char* begin, const char* end)
+{
+    while (end > begin &&
+           (end[-1] == ':' || end[-1] == ' ' || end[-1] == '\r'))
+        end--;
+    if (end - begin >= 2 && (*begin == '"' || *begin == '\'') &&
+        end[-1] == *begin)
+    {
+        begin++;
+        end--;
+    }
+    return string(begin, end);
+}
+
+/**
+ * Parse a float field, with the YAML spelling of infinities and NaN, which
+ * strtof does not accept.
+ */
+float parseFloat(const char* value, const char* end)
+{
+    while (end > value && (end[-1] == ' ' || end[-1] == '\r'))
+        end--;
+    const char* special = value;
+    if (special < end && (*special == '-' || *special == '+'))
+        special++;
+    if (special < end && *special == '.')
+    {
+        const string spelling(special + 1, end);
+        if (spelling == "nan" || spelling == "NaN" || spelling == "NAN")
+            return NAN;
+        if (spelling == "inf" || spelling == "Inf" || spelling == "INF")
+            return *value == '-' ? -INFINITY : INFINITY;
+    }
+    return strtof(value, nullptr);
+}
+
+bool isKeyLine(const char* begin, const char* end)
+{
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\r'))
+        end--;
+    return end > begin && end[-1] == ':';
+}
+
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day)
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const auto yearOfEra = (unsigned)(year - era * 400);
+    const unsigned dayOfYear =
+        (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra =
+        yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + (int64_t)dayOfEra - 719468;
+}
+
+bool parseNumber(const char*& c, const char* end, size_t digits, int& value)
+{
+    value = 0;
+    for (size_t i = 0; i < digits; i++, c++)
+    {
+        if (c >= end || *c < '0' || *c > '9')
+            return false;
+        value = value * 10 + (*c - '0');
+    }
+    return true;
+}
+} // namespace
+
+void ReportIndex::scan(const char* data, size_t size)
+{
+    if (resumeOffset > size || fingerprint(data, size) != reportFingerprint)
+    {
+        *this = ReportIndex();
+    }
+    if (resumeOffset == 0)
+        reportFingerprint = fingerprint(data, size);
+
+    // The last timestamp of the previous scan is scanned again.
+    blocks.erase(remove_if(blocks.begin(), blocks.end(),
+                           [this](const ReportBlock& block) {
+                               return block.offset >= resumeOffset;
+                           }),
+                 blocks.end());
+
+    const char* end = data + size;
+    const char* line = data + resumeOffset;
+    int64_t timestampMs = -1;
+    ReportBlock* block = nullptr;
+    while (line < end)
+    {
+        const char* lineEnd = static_cast<const char*>(
+            memchr(line, '\n', end - line));
+        if (lineEnd == nullptr)
+            break; // Incomplete line, left to the next scan.
+
+        const size_t indent = indentation(line, lineEnd);
+        if (indent == 0 && isKeyLine(line, lineEnd))
+        {
+            const string key = keyOf(line, lineEnd);
+            timestampMs = parseTimestamp(key.data(), key.size());
+            resumeOffset = line - data;
+            block = nullptr;
+        }
+        else if (indent == 2 && timestampMs >= 0 &&
+                 isKeyLine(line, lineEnd))
+        {
+            const uint32_t key = sensorKeyId(keyOf(line + indent, lineEnd));
+            blocks.push_back({timestampMs, key, (uint64_t)(line - data),
+                              (uint32_t)(lineEnd + 1 - line)});
+            block = &blocks.back();
+        }
+        else if (indent > 2 && block != nullptr)
+        {
+            block->length = (uint32_t)(lineEnd + 1 - data - block->offset);
+        }
+        else if (line + indent < lineEnd)
+        {
+            block = nullptr;
+        }
+        line = lineEnd + 1;
+    }
+    sortBlocks();
+}
+
+ReportIndex ReportIndex::load(const string& path)
+{
+    ifstream file(path, ios::binary);
+    if (!file)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to access %1%.") % path);
+        throw runtime_error(errorMessage);
+    }
+
+    char magic[sizeof(INDEX_MAGIC)];
+    uint16_t version = 0;
+    readValue(file, magic, path);
+    readValue(file, version, path);
+    if (!equal(begin(magic), end(magic), begin(INDEX_MAGIC)) ||
+        version != INDEX_VERSION)
+    {
+        const string errorMessage =
+            str(boost::format("%1% is not a version %2% report index.") %
+                path % INDEX_VERSION);
+        throw runtime_error(errorMessage);
+    }
+
+    ReportIndex index;
+    readValue(file, index.resumeOffset, path);
+    readValue(file, index.reportFingerprint, path);
+
+    uint32_t keyCount = 0;
+    readValue(file, keyCount, path);
+    for (uint32_t k = 0; k < keyCount; k++)
+    {
+        uint16_t length = 0;
+        readValue(file, length, path);
+        string key(length, '\0');
+        if (!file.read(key.data(), length))
+        {
+            const string errorMessage =
+                str(boost::format("Index %1% is truncated.") % path);
+            throw runtime_error(errorMessage);
+        }
+        index.sensorKeyId(key);
+    }
+
+    uint64_t blockCount = 0;
+    readValue(file, blockCount, path);
+    index.blocks.resize(blockCount);
+    for (auto& block : index.blocks)
+    {
+        readValue(file, block.timestampMs, path);
+        readValue(file, block.sensorKey, path);
+        readValue(file, block.offset, path);
+        readValue(file, block.length, path);
+        if (block.sensorKey >= keyCount)
+        {
+            const string errorMessage =
+                str(boost::format("Index %1% is corrupted.") % path);
+            throw runtime_error(errorMessage);
+        }
+    }
+    index.sortBlocks();
+    return index;
+}
+
+void ReportIndex::save(const string& path) const
+{
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to access %1%.") % path);
+        throw runtime_error(errorMessage);
+    }
+
+    file.write(INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    writeValue(file, INDEX_VERSION);
+    writeValue(file, resumeOffset);
+    writeValue(file, reportFingerprint);
+    writeValue(file, (uint32_t)sensorKeys.size());
+    for (const auto& key : sensorKeys)
+    {
+        writeValue(file, (uint16_t)key.size());
+        file.write(key.data(), (streamsize)key.size());
+    }
+    writeValue(file, (uint64_t)blocks.size());
+    for (const auto& block : blocks)
+    {
+        writeValue(file, block.timestampMs);
+        writeValue(file, block.sensorKey);
+        writeValue(file, block.offset);
+        writeValue(file, block.length);
+    }
+
+    if (!file)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to write index %1%.") % path);
+        throw runtime_error(errorMessage);
+    }
+}
+
+vector<ReportBlock> ReportIndex::find(int64_t fromMs, int64_t toMs,
+                                      const string& sensorKey) const
+{
+    vector<ReportBlock> found;
+    if (sensorKey.empty())
+    {
+        auto it = lower_bound(blocks.begin(), blocks.end(), fromMs,
+                              [](const ReportBlock& block, int64_t time) {
+                                  return block.timestampMs < time;
+                              });
+        for (; it != blocks.end() && it->timestampMs <= toMs; ++it)
+            found.push_back(*it);
+        return found;
+    }
+
+    const auto key = sensorKeyIds.find(sensorKey);
+    if (key == sensorKeyIds.end())
+        return found;
+    const vector<uint32_t>& sensor = sensorBlocks[key->second];
+    auto it = lower_bound(sensor.begin(), sensor.end(), fromMs,
+                          [this](uint32_t block, int64_t time) {
+                              return blocks[block].timestampMs < time;
+                          });
+    for (; it != sensor.end() && blocks[*it].timestampMs <= toMs; ++it)
+        found.push_back(blocks[*it]);
+    return found;
+}
+
+const vector<string>& ReportIndex::getSensorKeys() const { return sensorKeys; }
+
+const vector<ReportBlock>& ReportIndex::getBlocks() const { return blocks; }
+
+uint64_t ReportIndex::getResumeOffset() const { return resumeOffset; }
+
+uint64_t ReportIndex::getFingerprint() const { return reportFingerprint; }
+
+uint64_t ReportIndex::fingerprint(const char* data, size_t size)
+{
+    // FNV-1a.
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < min(size, FINGERPRINT_SIZE); i++)
+    {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+int64_t ReportIndex::parseTimestamp(const char* text, size_t size)
+{
+    static constexpr char MONTHS[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+    // Format of boost::posix_time::to_simple_string, e.g.
+    // "2021-Feb-09 20:55:51" with optional fractional seconds.
+    const char* c = text;
+    const char* end = text + size;
+    int year, day, hours, minutes, seconds;
+    if (!parseNumber(c, end, 4, year) || c + 5 > end || *c++ != '-')
+        return -1;
+    const char* month = strstr(MONTHS, string(c, 3).c_str());
+    if (month == nullptr || (month - MONTHS) % 3 != 0)
+        return -1;
+    c += 3;
+    if (c >= end || *c++ != '-' || !parseNumber(c, end, 2, day) ||
+        c >= end || *c++ != ' ' || !parseNumber(c, end, 2, hours) ||
+        c >= end || *c++ != ':' || !parseNumber(c, end, 2, minutes) ||
+        c >= end || *c++ != ':' || !parseNumber(c, end, 2, seconds))
+        return -1;
+
+    int64_t milliseconds = 0;
+    if (c < end && *c == '.')
+    {
+        int64_t scale = 100;
+        for (c++; c < end && *c >= '0' && *c <= '9'; c++, scale /= 10)
+            milliseconds += (*c - '0') * scale;
+    }
+    if (c != end)
+        return -1;
+
+    const int64_t days =
+        daysFromCivil(year, (unsigned)((month - MONTHS) / 3 + 1), day);
+    return ((days * 24 + hours) * 60 + minutes) * 60000 + seconds * 1000 +
+           milliseconds;
+}
+
+uint32_t ReportIndex::sensorKeyId(const string& key)
+{
+    const auto [it, inserted] =
+        sensorKeyIds.emplace(key, (uint32_t)sensorKeys.size());
+    if (inserted)
+        sensorKeys.push_back(key);
+    return it->second;
+}
+
+void ReportIndex::sortBlocks()
+{
+    stable_sort(blocks.begin(), blocks.end(),
+                [](const ReportBlock& a, const ReportBlock& b) {
+                    return a.timestampMs < b.timestampMs;
+                });
+    sensorBlocks.assign(sensorKeys.size(), {});
+    for (uint32_t i = 0; i < blocks.size(); i++)
+        sensorBlocks[blocks[i].sensorKey].push_back(i);
+}
+
+ReportReader::ReportReader(string path, bool saveIndex) : path(move(path))
+{
+    int fd = open(this->path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to access %1%.") % this->path);
+        throw runtime_error(errorMessage);
+    }
+    struct stat status = {};
+    fstat(fd, &status);
+    size = (size_t)status.st_size;
+    if (size > 0)
+    {
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            close(fd);
+            const string errorMessage =
+                str(boost::format("Impossible to map %1%.") % this->path);
+            throw runtime_error(errorMessage);
+        }
+        data = static_cast<const char*>(mapping);
+    }
+    close(fd);
+
+    try
+    {
+        index = ReportIndex::load(indexPath(this->path));
+    }
+    catch (const runtime_error& e)
+    {
+        // No usable sidecar index, the report is scanned from the start.
+    }
+
+    const uint64_t resumeOffset = index.getResumeOffset();
+    const uint64_t fingerprint = index.getFingerprint();
+    index.scan(data, size);
+    if (saveIndex && (index.getResumeOffset() != resumeOffset ||
+                      index.getFingerprint() != fingerprint))
+    {
+        // Best effort: a report in a read-only archive is still readable,
+        // with the index kept in memory.
+        try
+        {
+            index.save(indexPath(this->path));
+        }
+        catch (const runtime_error& e)
+        {
+            cerr << e.what() << endl;
+        }
+    }
+}
+
+ReportReader::~ReportReader()
+{
+    if (data != nullptr)
+        munmap(const_cast<char*>(data), size);
+}
+
+vector<ReportSample> ReportReader::query(int64_t fromMs, int64_t toMs,
+                                         const string& sensorKey) const
+{
+    vector<ReportSample> samples;
+    for (const auto& block : index.find(fromMs, toMs, sensorKey))
+        samples.push_back(decode(block));
+    return samples;
+}
+
+ReportSample ReportReader::decode(const ReportBlock& block) const
+{
+    ReportSample sample;
+    sample.timestampMs = block.timestampMs;
+    sample.sensorKey = index.getSensorKeys().at(block.sensorKey);
+    if (block.offset + block.length > size)
+    {
+        const string errorMessage =
+            str(boost::format("Index of %1% is out of date.") % path);
+        throw runtime_error(errorMessage);
+    }
+
+    const char* line = data + block.offset;
+    const char* end = line + block.length;
+    while (line < end)
+    {
+        const char* lineEnd =
+            static_cast<const char*>(memchr(line, '\n', end - line));
+        if (lineEnd == nullptr)
+            lineEnd = end;
+        const char* field = line + indentation(line, lineEnd);
+        const char* separator = static_cast<const char*>(
+            memchr(field, ':', lineEnd - field));
+        line = lineEnd + 1;
+        if (separator == nullptr || separator + 1 >= lineEnd)
+            continue;
+
+        const string name(field, separator);
+        const char* value = separator + 2;
+        if (name == "Hardware Id")
+            sample.hardwareId = (uint16_t)strtoul(value, nullptr, 10);
+        else if (name == "Name")
+            sample.name = keyOf(value, lineEnd);
+        else if (name == "Status")
+            sample.faulted = keyOf(value, lineEnd) == "Fault";
+        else if (name == "Temperature")
+            sample.temperature = parseFloat(value, lineEnd);
+        else if (name == "Min temperature")
+            sample.minTemperature = parseFloat(value, lineEnd);
+        else if (name == "Max temperature")
+            sample.maxTemperature = parseFloat(value, lineEnd);
+    }
+    return sample;
+}
+
+const ReportIndex& ReportReader::getIndex() const { return index; }
+
+string ReportReader::indexPath(const string& reportPath)
+{
+    return reportPath + ".idx";
+}
@@ -0,0 +1,176 @@
+#ifndef TAKING_THE_TEMPERATURE_REPORTREADER_H
+#define TAKING_THE_TEMPERATURE_REPORTREADER_H
+
+// STD includes
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Location of one sensor entry in a report file.
+ */
+struct ReportBlock
+{
+    //! Time of the reading, in ms since epoch.
+    int64_t timestampMs;
+    //! Index of the sensor key, see ReportIndex::getSensorKeys().
+    uint32_t sensorKey;
+    //! Byte offset of the entry in the report.
+    uint64_t offset;
+    //! Length of the entry, in bytes.
+    uint32_t length;
+};
+
+/**
+ * @brief Sensor entry decoded from a report file.
+ */
+struct ReportSample
+{
+    int64_t timestampMs = 0;
+    string sensorKey;
+    uint16_t hardwareId = 0;
+    string name;
+    //! NaN for a faulted sensor.
+    float temperature = 0.f;
+    float minTemperature = 0.f;
+    float maxTemperature = 0.f;
+    //! Whether the sensor failed to read, "Status: Fault" in the report.
+    bool faulted = false;
+};
+
+/**
+ * @brief Index of a report file, by timestamp and sensor key.
+ * The report is scanned line by line instead of being parsed as a YAML
+ * document: top level keys are timestamps, keys indented by two spaces are
+ * sensor entries. Blocks are sorted by timestamp.
+ */
+class ReportIndex
+{
+public:
+    /**
+     * @brief Scan a report and index its sensor entries.
+     * When the index already covers the beginning of the report, only the
+     * part after getResumeOffset() is scanned.
+     * @param data: content of the report.
+     * @param size: size of the content.
+     */
+    void scan(const char* data, size_t size);
+
+    /**
+     * @brief Load a sidecar index written by save().
+     * @throw runtime_error: if the file cannot be read or is not an index.
+     */
+    static ReportIndex load(const string& path);
+
+    /**
+     * @brief Save the index to a sidecar file.
+     * @throw runtime_error: if the file cannot be written.
+     */
+    void save(const string& path) const;
+
+    /**
+     * @brief Find the entries in a time range.
+     * @param fromMs: first time, included, in ms since epoch.
+     * @param toMs: last time, included, in ms since epoch.
+     * @param sensorKey: restrict to this sensor, e.g. "2-PT1000". All the
+     * sensors if empty.
+     * @return Matching blocks sorted by timestamp.
+     */
+    [[nodiscard]] vector<ReportBlock> find(int64_t fromMs, int64_t toMs,
+                                           const string& sensorKey = "") const;
+
+    [[nodiscard]] const vector<string>& getSensorKeys() const;
+
+    [[nodiscard]] const vector<ReportBlock>& getBlocks() const;
+
+    /**
+     * @brief Get the offset from which a later scan() resumes.
+     * It is the start of the last timestamp, whose entries may not have
+     * been completely written yet when the report was scanned.
+     */
+    [[nodiscard]] uint64_t getResumeOffset() const;
+
+    /**
+     * @brief Get the hash of the first bytes of the indexed report.
+     * It tells whether a report is still the one that was indexed, e.g.
+     * after a rotation.
+     */
+    [[nodiscard]] uint64_t getFingerprint() const;
+
+    /**
+     * @brief Hash the first bytes of a report.
+     */
+    static uint64_t fingerprint(const char* data, size_t size);
+
+    /**
+     * @brief Parse a report timestamp, e.g. "2021-Feb-09 20:55:51".
+     * @return Time in ms since epoch, or -1 if the text is not a timestamp.
+     */
+    static int64_t parseTimestamp(const char* text, size_t size);
+
+private:
+    vector<string> sensorKeys;
+    /// Index of each sensor key in sensorKeys.
+    unordered_map<string, uint32_t> sensorKeyIds;
+    vector<ReportBlock> blocks;
+    /// Blocks of each sensor key, as indices in blocks.
+    vector<vector<uint32_t>> sensorBlocks;
+    uint64_t resumeOffset = 0;
+    uint64_t reportFingerprint = 0;
+
+    uint32_t sensorKeyId(const string& key);
+    void sortBlocks();
+};
+
+/**
+ * @brief Random-access reader of a report file.
+ * The report is mapped in memory and queries only decode the matching
+ * entries. The sidecar index "<report>.idx" is reused when it is up to
+ * date, extended when the report has grown since, and rebuilt otherwise.
+ */
+class ReportReader
+{
+public:
+    /**
+     * @param path: path to the report file.
+     * @param saveIndex: write the sidecar index when it changed. A failure
+     * to write it is only reported on the standard error.
+     * @throw runtime_error: if the report cannot be mapped.
+     */
+    explicit ReportReader(string path, bool saveIndex = true);
+
+    ~ReportReader();
+
+    ReportReader(const ReportReader&) = delete;
+    ReportReader& operator=(const ReportReader&) = delete;
+
+    /**
+     * @brief Decode the entries in a time range.
+     * @see ReportIndex::find()
+     */
+    [[nodiscard]] vector<ReportSample>
+    query(int64_t fromMs, int64_t toMs, const string& sensorKey = "") const;
+
+    /**
+     * @brief Decode one sensor entry.
+     */
+    [[nodiscard]] ReportSample decode(const ReportBlock& block) const;
+
+    [[nodiscard]] const ReportIndex& getIndex() const;
+
+    /**
+     * @brief Get the path of the sidecar index of a report.
+     */
+    static string indexPath(const string& reportPath);
+
+private:
+    string path;
+    const char* data = nullptr;
+    size_t size = 0;
+    ReportIndex index;
+};
+
+#endif // TAKING_THE_TEMPERATURE_REPORTREADER_H
@@ -0,0 +1,297 @@
+// C includes
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// STD includes
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+
+// Third parties includes
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/iostreams/device/back_inserter.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+
+// Local includes
+#include "ReportWriter.h"
+
+using namespace std;
+
+ReportWriter::Device::Device(ReportWriter* writer) : writer(writer) {}
+
+streamsize ReportWriter::Device::write(const char* data, streamsize size)
+{
+    writer->write(data, size);
+    return size;
+}
+
+bool ReportWriter::Device::flush()
+{
+    // The stream buffer turns exceptions into the bad bit of the stream:
+    // the message is kept for getLastError().
+    try
+    {
+        writer->endCycle();
+    }
+    catch (const runtime_error& e)
+    {
+        writer->lastError = e.what();
+        throw;
+    }
+    writer->lastError.clear();
+    return true;
+}
+
+ReportWriter::ReportWriter(string path, ReportWriterConfig config,
+                           Clock& clock)
+    : path(move(path)), config(config), clock(clock), cycles(1),
+      stream(Device(this))
+{
+    if (config.cyclesPerBatch == 0 || config.fsyncCycles == 0)
+        throw invalid_argument("Batch and fsync cycle counts should be "
+                               "strictly positive.");
+    cycles.resize(config.cyclesPerBatch + 1);
+    open();
+}
+
+ReportWriter::~ReportWriter()
+{
+    try
+    {
+        close();
+    }
+    catch (const runtime_error& e)
+    {
+        // Destructor should not throw, pending cycles are lost.
+        cerr << e.what() << endl;
+    }
+}
+
+ostream& ReportWriter::getStream() { return stream; }
+
+void ReportWriter::write(const char* data, streamsize size)
+{
+    cycles[pendingCycles].append(data, size);
+}
+
+void ReportWriter::endCycle()
+{
+    if (cycles[pendingCycles].empty())
+        return;
+
+    pendingCycles++;
+    if (pendingCycles == cycles.size())
+        cycles.emplace_back();
+    if (pendingCycles >= config.cyclesPerBatch)
+        commit();
+}
+
+void ReportWriter::commit()
+{
+    if (pendingCycles == 0)
+        return;
+    if (fd == -1)
+    {
+        const string errorMessage =
+            str(boost::format("Report %1% is already closed.") % path);
+        throw runtime_error(errorMessage);
+    }
+
+    writeBatch();
+    cyclesSinceFsync += pendingCycles;
+    for (size_t i = 0; i < pendingCycles; i++)
+    {
+        largestCycle = max(largestCycle, cycles[i].size());
+        cycles[i].clear();
+    }
+    // Keep the cycle in progress, if any, at the front.
+    swap(cycles[0], cycles[pendingCycles]);
+    // Headroom, so that the buffers are not reallocated as soon as a cycle
+    // is a few bytes longer than the previous ones.
+    for (auto& cycle : cycles)
+        if (cycle.capacity() < largestCycle + largestCycle / 2)
+            cycle.reserve(2 * largestCycle);
+    pendingCycles = 0;
+
+    sync();
+
+    const auto age = clock.steadyNow() - openedAt;
+    if ((config.rotationSize > 0 && fileSize >= config.rotationSize) ||
+        (config.rotationPeriod > chrono::milliseconds::zero() &&
+         age >= config.rotationPeriod))
+    {
+        rotate();
+    }
+}
+
+void ReportWriter::close()
+{
+    if (fd == -1)
+        return;
+
+    // Closing the stream flushes it, which ends the last cycle.
+    if (stream.is_open())
+        stream.close();
+    commit();
+    if (config.fsyncPolicy != FSYNC_NEVER)
+    {
+        fdatasync(fd);
+        fsyncCount++;
+    }
+    ::close(fd);
+    fd = -1;
+}
+
+uint64_t ReportWriter::getFileSize() const { return fileSize; }
+
+size_t ReportWriter::getWritevCount() const { return writevCount; }
+
+size_t ReportWriter::getFsyncCount() const { return fsyncCount; }
+
+size_t ReportWriter::getRotationCount() const { return rotationCount; }
+
+const string& ReportWriter::getPath() const { return path; }
+
+const string& ReportWriter::getLastError() const { return lastError; }
+
+void ReportWriter::open()
+{
+    // Open file output stream properly.
+    // See https://security.web.cern.ch/recommendations/en/codetools/cpp.shtml
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0600);
+    if (fd == -1)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to access %1%.") % path);
+        throw invalid_argument(errorMessage);
+    }
+
+    struct stat status = {};
+    fileSize = fstat(fd, &status) == 0 ? (uint64_t)status.st_size : 0;
+    openedAt = clock.steadyNow();
+    lastFsync = openedAt;
+    cyclesSinceFsync = 0;
+}
+
+void ReportWriter::sync()
+{
+    bool due = false;
+    switch (config.fsyncPolicy)
+    {
+        case FSYNC_NEVER:
+            break;
+        case FSYNC_EVERY_N_CYCLES:
+            due = cyclesSinceFsync >= config.fsyncCycles;
+            break;
+        case FSYNC_EVERY_T_MS:
+            due = clock.steadyNow() - lastFsync >=
+                  config.fsyncPeriod;
+            break;
+    }
+    if (!due)
+        return;
+
+    if (fdatasync(fd) == -1)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to sync %1%: %2%") % path %
+                strerror(errno));
+        throw runtime_error(errorMessage);
+    }
+    fsyncCount++;
+    cyclesSinceFsync = 0;
+    lastFsync = clock.steadyNow();
+}
+
+void ReportWriter::rotate()
+{
+    // On failure the file is left open, so that the next cycle retries.
+    if (config.fsyncPolicy != FSYNC_NEVER)
+    {
+        if (fdatasync(fd) == -1)
+        {
+            const string errorMessage =
+                str(boost::format("Impossible to sync %1%: %2%") % path %
+                    strerror(errno));
+            throw runtime_error(errorMessage);
+        }
+        fsyncCount++;
+    }
+
+    // Rotated files are never removed by the writer: the search resumes
+    // after the last one, instead of probing all of them at each rotation.
+    // The file is renamed while still open, and only closed once renamed.
+    while (boost::filesystem::exists(path + "." + to_string(rotationIndex)))
+        rotationIndex++;
+    boost::filesystem::rename(path, path + "." + to_string(rotationIndex));
+    rotationIndex++;
+    rotationCount++;
+
+    ::close(fd);
+    fd = -1;
+    open();
+}
+
+void ReportWriter::writeBatch()
+{
+    iovecs.clear();
+    if (config.compression == COMPRESSION_NONE)
+    {
+        for (size_t i = 0; i < pendingCycles; i++)
+            iovecs.push_back({cycles[i].data(), cycles[i].size()});
+    }
+    else
+    {
+        // Each batch is a complete gzip member or zstd frame, and
+        // concatenated members decompress as a single stream.
+        compressed.clear();
+        io::filtering_ostream out;
+        if (config.compression == COMPRESSION_GZIP)
+            out.push(io::gzip_compressor());
+        else
+            out.push(io::zstd_compressor());
+        out.push(io::back_inserter(compressed));
+        for (size_t i = 0; i < pendingCycles; i++)
+            out.write(cycles[i].data(), (streamsize)cycles[i].size());
+        out.reset();
+        iovecs.push_back({compressed.data(), compressed.size()});
+    }
+
+    size_t first = 0;
+    while (first < iovecs.size())
+    {
+        const auto count = (int)min<size_t>(iovecs.size() - first, IOV_MAX);
+        const ssize_t written = writev(fd, &iovecs[first], count);
+        if (written == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            const string errorMessage =
+                str(boost::format("Impossible to write report %1%: %2%") %
+                    path % strerror(errno));
+            throw runtime_error(errorMessage);
+        }
+        writevCount++;
+        fileSize += (uint64_t)written;
+
+        // Skip what has been written, partial writes resume mid-buffer.
+        auto remaining = (size_t)written;
+        while (first < iovecs.size() && remaining >= iovecs[first].iov_len)
+        {
+            remaining -= iovecs[first].iov_len;
+            first++;
+        }
+        if (remaining > 0)
+        {
+            iovecs[first].iov_base =
+                static_cast<char*>(iovecs[first].iov_base) + remaining;
+            iovecs[first].iov_len -= remaining;
+        }
+    }
+}
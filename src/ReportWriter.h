@@ -0,0 +1,192 @@
+#ifndef TAKING_THE_TEMPERATURE_REPORTWRITER_H
+#define TAKING_THE_TEMPERATURE_REPORTWRITER_H
+
+// C includes
+#include <sys/uio.h>
+
+// STD includes
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Third parties includes
+#include <boost/iostreams/categories.hpp>
+#include <boost/iostreams/stream.hpp>
+
+// Local includes
+#include "Clock.h"
+
+namespace io = boost::iostreams;
+using namespace std;
+
+enum FsyncPolicy
+{
+    FSYNC_NEVER = 0,          /**< Leave durability to the kernel */
+    FSYNC_EVERY_N_CYCLES = 1, /**< fsync once every N cycles */
+    FSYNC_EVERY_T_MS = 2      /**< fsync at most once every T ms */
+};
+
+enum ReportCompression
+{
+    COMPRESSION_NONE = 0, /**< Plain text */
+    COMPRESSION_GZIP = 1, /**< One gzip member per batch */
+    COMPRESSION_ZSTD = 2  /**< One zstd frame per batch */
+};
+
+struct ReportWriterConfig
+{
+    //! Number of cycles gathered into a single writev.
+    size_t cyclesPerBatch = 1;
+    //! Durability policy.
+    FsyncPolicy fsyncPolicy = FSYNC_NEVER;
+    //! Cycles between two fsync, for FSYNC_EVERY_N_CYCLES.
+    size_t fsyncCycles = 1;
+    //! Time between two fsync, for FSYNC_EVERY_T_MS.
+    chrono::milliseconds fsyncPeriod = chrono::milliseconds(1000);
+    //! Rotate once the file reaches this size, in bytes. 0 disables.
+    uint64_t rotationSize = 0;
+    //! Rotate once the file is this old. 0 disables.
+    chrono::milliseconds rotationPeriod = chrono::milliseconds::zero();
+    //! Compression of the written batches.
+    ReportCompression compression = COMPRESSION_NONE;
+};
+
+/**
+ * @brief Report sink committing cycles to a file in groups.
+ * Reports are written to getStream(), and each flush of that stream marks
+ * the end of a cycle, as done by VmeSystem after each report. Cycles are
+ * kept in memory until cyclesPerBatch of them are pending, then written
+ * with a single writev, compressed if required, and synced according to
+ * the fsync policy.
+ * Rotated files are renamed to "<path>.<index>", with the first free index.
+ * Errors of the cycles ended through the stream cannot be thrown through
+ * it: they set the bad bit of the stream, and are kept in getLastError().
+ */
+class ReportWriter
+{
+public:
+    /**
+     * @param path: path of the report file, opened in append mode.
+     * @param config: batching, durability, rotation and compression.
+     * @param clock: clock of the fsync and rotation periods, not owned.
+     * @throw invalid_argument: if the file cannot be opened or the
+     * configuration is not valid.
+     */
+    explicit ReportWriter(string path, ReportWriterConfig config = {},
+                          Clock& clock = realClock());
+
+    //! Commit pending cycles and close the file.
+    ~ReportWriter();
+
+    ReportWriter(const ReportWriter&) = delete;
+    ReportWriter& operator=(const ReportWriter&) = delete;
+
+    /**
+     * @brief Get the stream to produce reports into.
+     * @see VmeSystem::setOutputStream()
+     */
+    ostream& getStream();
+
+    /**
+     * @brief Append data to the current cycle.
+     */
+    void write(const char* data, streamsize size);
+
+    /**
+     * @brief Close the current cycle, and commit if the batch is full.
+     * Cycles not written are kept, and retried by the next commit.
+     * @throw runtime_error: if writing, syncing or rotating the file fails.
+     * When the cycle is ended by a flush of getStream(), the error is not
+     * thrown, see getLastError().
+     */
+    void endCycle();
+
+    /**
+     * @brief Write all the pending cycles, regardless of the batch size.
+     * @throw runtime_error: if writing, syncing or rotating the file fails.
+     */
+    void commit();
+
+    /**
+     * @brief Commit pending cycles, sync and close the file.
+     * Further writes are not allowed.
+     */
+    void close();
+
+    /**
+     * @brief Get the number of bytes in the current file.
+     */
+    [[nodiscard]] uint64_t getFileSize() const;
+
+    [[nodiscard]] size_t getWritevCount() const;
+
+    [[nodiscard]] size_t getFsyncCount() const;
+
+    [[nodiscard]] size_t getRotationCount() const;
+
+    [[nodiscard]] const string& getPath() const;
+
+    /**
+     * @brief Get the error of the last cycle ended by a flush of
+     * getStream(), empty if it was committed or is still pending.
+     */
+    [[nodiscard]] const string& getLastError() const;
+
+private:
+    /**
+     * @brief Boost.Iostreams device forwarding to the writer.
+     * Flushing the device ends the current cycle.
+     */
+    class Device
+    {
+    public:
+        typedef char char_type;
+        struct category : io::sink_tag, io::flushable_tag
+        {
+        };
+
+        explicit Device(ReportWriter* writer);
+        streamsize write(const char* data, streamsize size);
+        bool flush();
+
+    private:
+        ReportWriter* writer;
+    };
+
+    string path;
+    ReportWriterConfig config;
+    Clock& clock;
+    int fd = -1;
+    uint64_t fileSize = 0;
+    chrono::steady_clock::time_point openedAt;
+    chrono::steady_clock::time_point lastFsync;
+    size_t cyclesSinceFsync = 0;
+    size_t writevCount = 0;
+    size_t fsyncCount = 0;
+    size_t rotationCount = 0;
+    /// Lowest suffix that may be free for the next rotated file.
+    size_t rotationIndex = 1;
+    /// Error of the last cycle ended through the stream.
+    string lastError;
+
+    /// Cycles, the first pendingCycles are complete. Buffers are reused.
+    vector<string> cycles;
+    size_t pendingCycles = 0;
+    /// Largest cycle written so far.
+    size_t largestCycle = 0;
+    /// Batch once compressed.
+    string compressed;
+    /// Buffers of the batch being written.
+    vector<iovec> iovecs;
+
+    io::stream<Device> stream;
+
+    void open();
+    void sync();
+    void rotate();
+    void writeBatch();
+};
+
+#endif // TAKING_THE_TEMPERATURE_REPORTWRITER_H
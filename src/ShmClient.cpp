@@ -0,0 +1,167 @@
+// C includes
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// STD includes
+#include <stdexcept>
+
+// Third parties includes
+#include <boost/format.hpp>
+
+// Local includes
+#include "ShmClient.h"
+
+using namespace std;
+
+ShmClient::ShmClient(const string& name)
+{
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd == -1)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to access shared memory %1%.") %
+                name);
+        throw runtime_error(errorMessage);
+    }
+    struct stat status = {};
+    fstat(fd, &status);
+    segmentSize = (size_t)status.st_size;
+    if (segmentSize >= sizeof(ShmHeader))
+        segment = mmap(nullptr, segmentSize, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == nullptr || segment == MAP_FAILED)
+    {
+        segment = nullptr;
+        const string errorMessage =
+            str(boost::format("Impossible to map shared memory %1%.") % name);
+        throw runtime_error(errorMessage);
+    }
+
+    header = static_cast<const ShmHeader*>(segment);
+    bool valid;
+    uint32_t before;
+    uint32_t after;
+    // A publisher that died while reinitialising leaves the sequence odd.
+    int attempts = 1000;
+    do
+    {
+        before = header->sequence.load(memory_order_acquire);
+        valid = header->magic.load(memory_order_acquire) == SHM_MAGIC &&
+                header->version == SHM_VERSION &&
+                header->segmentSize == segmentSize &&
+                shmSegmentSize(header->channelCapacity, header->ringSize) ==
+                    segmentSize;
+        atomic_thread_fence(memory_order_acquire);
+        after = header->sequence.load(memory_order_relaxed);
+        valid = valid && (before & 1) == 0 && before == after;
+    } while (!valid && --attempts > 0);
+    if (!valid)
+    {
+        munmap(segment, segmentSize);
+        segment = nullptr;
+        const string errorMessage =
+            str(boost::format("Shared memory %1% is not a version %2% "
+                              "temperature segment.") %
+                name % SHM_VERSION);
+        throw runtime_error(errorMessage);
+    }
+}
+
+ShmClient::~ShmClient()
+{
+    if (segment != nullptr)
+        munmap(segment, segmentSize);
+}
+
+uint64_t ShmClient::getLatestCycle() const
+{
+    return header->latestCycle.load(memory_order_acquire);
+}
+
+bool ShmClient::readChannel(uint16_t hardwareId,
+                            ShmChannelReading& reading) const
+{
+    if (hardwareId >= header->channelCapacity)
+        return false;
+
+    const ShmChannel& channel = shmChannels(segment)[hardwareId];
+    uint32_t valid;
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+        before = channel.sequence.load(memory_order_acquire);
+        valid = channel.valid;
+        reading.cycle = channel.cycle;
+        reading.timestampNs = channel.timestampNs;
+        reading.reading = channel.reading;
+        atomic_thread_fence(memory_order_acquire);
+        after = channel.sequence.load(memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    return valid != 0;
+}
+
+bool ShmClient::readCycle(uint64_t cycle, SweepSnapshot& snapshot) const
+{
+    const uint64_t latest = getLatestCycle();
+    if (cycle == 0 || cycle > latest || latest - cycle >= header->ringSize)
+        return false;
+
+    ShmCycle* slot = shmCycle(segment, cycle);
+    const ChannelReading* readings = shmCycleReadings(slot);
+    uint32_t before;
+    uint32_t after;
+    do
+    {
+        before = slot->sequence.load(memory_order_acquire);
+        snapshot.cycle = slot->cycle;
+        snapshot.timestampNs = slot->timestampNs;
+        const uint32_t count =
+            min(slot->readingCount, header->channelCapacity);
+        snapshot.readings.assign(readings, readings + count);
+        atomic_thread_fence(memory_order_acquire);
+        after = slot->sequence.load(memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+
+    // The slot may have been reused by a newer cycle meanwhile.
+    return snapshot.cycle == cycle;
+}
+
+uint64_t ShmClient::waitForCycle(uint64_t cycle,
+                                 chrono::nanoseconds timeout) const
+{
+    const auto deadline = chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        const uint32_t futexValue =
+            header->cycleFutex.load(memory_order_acquire);
+        const uint64_t latest = getLatestCycle();
+        if (latest != cycle)
+            return latest;
+
+        const auto remaining = deadline - chrono::steady_clock::now();
+        if (remaining <= chrono::nanoseconds::zero())
+            return latest;
+        const auto seconds = chrono::duration_cast<chrono::seconds>(remaining);
+        timespec relative = {
+            (time_t)seconds.count(),
+            (long)chrono::duration_cast<chrono::nanoseconds>(remaining -
+                                                             seconds)
+                .count()};
+        // Returns at once if a cycle was published since futexValue.
+        syscall(SYS_futex, &header->cycleFutex, FUTEX_WAIT, futexValue,
+                &relative, nullptr, 0);
+    }
+}
+
+uint32_t ShmClient::getChannelCapacity() const
+{
+    return header->channelCapacity;
+}
+
+uint32_t ShmClient::getRingSize() const { return header->ringSize; }
@@ -0,0 +1,81 @@
+#ifndef TAKING_THE_TEMPERATURE_SHMCLIENT_H
+#define TAKING_THE_TEMPERATURE_SHMCLIENT_H
+
+// STD includes
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Local includes
+#include "ShmLayout.h"
+#include "SweepPublisher.h"
+
+using namespace std;
+
+/**
+ * @brief Latest reading of a channel, as published in shared memory.
+ */
+struct ShmChannelReading
+{
+    uint64_t cycle = 0;
+    int64_t timestampNs = 0;
+    ChannelReading reading = {};
+};
+
+/**
+ * @brief Read-only client of a segment published by ShmPublisher.
+ * Reads only copy from the mapped segment, they do not make any system
+ * call. Only waitForCycle() may block, on a futex.
+ */
+class ShmClient
+{
+public:
+    /**
+     * @param name: name of the segment, e.g. "/ttt_crate1".
+     * @throw runtime_error: if the segment does not exist or its layout is
+     * not supported.
+     */
+    explicit ShmClient(const string& name);
+
+    ~ShmClient();
+
+    ShmClient(const ShmClient&) = delete;
+    ShmClient& operator=(const ShmClient&) = delete;
+
+    /**
+     * @brief Get the last published cycle, 0 before the first one.
+     */
+    [[nodiscard]] uint64_t getLatestCycle() const;
+
+    /**
+     * @brief Read the latest reading of a channel.
+     * @return false if no sensor is registered on this channel.
+     */
+    bool readChannel(uint16_t hardwareId, ShmChannelReading& reading) const;
+
+    /**
+     * @brief Read a recent cycle from the ring.
+     * @return false if the cycle has not been published yet or has already
+     * been overwritten.
+     */
+    bool readCycle(uint64_t cycle, SweepSnapshot& snapshot) const;
+
+    /**
+     * @brief Wait until a cycle newer than the given one is published.
+     * @param cycle: last cycle seen by the caller.
+     * @param timeout: maximum waiting time.
+     * @return Latest cycle, equal to the given one on timeout.
+     */
+    uint64_t waitForCycle(uint64_t cycle, chrono::nanoseconds timeout) const;
+
+    [[nodiscard]] uint32_t getChannelCapacity() const;
+
+    [[nodiscard]] uint32_t getRingSize() const;
+
+private:
+    void* segment = nullptr;
+    size_t segmentSize = 0;
+    const ShmHeader* header = nullptr;
+};
+
+#endif // TAKING_THE_TEMPERATURE_SHMCLIENT_H
@@ -0,0 +1,96 @@
+#ifndef TAKING_THE_TEMPERATURE_SHMLAYOUT_H
+#define TAKING_THE_TEMPERATURE_SHMLAYOUT_H
+
+// STD includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Local includes
+#include "SweepPublisher.h"
+
+/**
+ * Layout of the shared-memory segment published by ShmPublisher:
+ *   ShmHeader
+ *   ShmChannel[channelCapacity], indexed by hardware Id
+ *   ring of ringSize cycles, each a ShmCycle followed by
+ *   ChannelReading[channelCapacity]
+ *
+ * Every channel and cycle is guarded by a sequence lock: the writer makes
+ * the sequence odd, writes the data and makes it even again. Readers copy
+ * the data and retry if the sequence was odd or has changed meanwhile.
+ */
+
+constexpr uint32_t SHM_MAGIC = 0x53545454; // "TTTS"
+constexpr uint32_t SHM_VERSION = 1;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "Shared atomics should be lock free.");
+
+struct ShmHeader
+{
+    //! SHM_MAGIC, written last once the segment is initialised.
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint32_t channelCapacity;
+    uint32_t ringSize;
+    uint64_t segmentSize;
+    //! Last published cycle, 0 before the first one.
+    std::atomic<uint64_t> latestCycle;
+    //! Low 32 bits of latestCycle, futex word woken at each cycle.
+    std::atomic<uint32_t> cycleFutex;
+    //! Sequence lock of the header, odd while a publisher reinitialises it.
+    std::atomic<uint32_t> sequence;
+};
+
+struct ShmChannel
+{
+    std::atomic<uint32_t> sequence;
+    //! 1 if a sensor is registered on this channel.
+    uint32_t valid;
+    uint64_t cycle;
+    int64_t timestampNs;
+    ChannelReading reading;
+};
+
+struct ShmCycle
+{
+    std::atomic<uint32_t> sequence;
+    uint32_t readingCount;
+    uint64_t cycle;
+    int64_t timestampNs;
+};
+
+inline size_t shmCycleSize(uint32_t channelCapacity)
+{
+    return sizeof(ShmCycle) + channelCapacity * sizeof(ChannelReading);
+}
+
+inline size_t shmSegmentSize(uint32_t channelCapacity, uint32_t ringSize)
+{
+    return sizeof(ShmHeader) + channelCapacity * sizeof(ShmChannel) +
+           ringSize * shmCycleSize(channelCapacity);
+}
+
+inline ShmChannel* shmChannels(void* segment)
+{
+    return reinterpret_cast<ShmChannel*>(static_cast<char*>(segment) +
+                                         sizeof(ShmHeader));
+}
+
+inline ShmCycle* shmCycle(void* segment, uint64_t cycle)
+{
+    const auto* header = static_cast<const ShmHeader*>(segment);
+    return reinterpret_cast<ShmCycle*>(
+        reinterpret_cast<char*>(shmChannels(segment) +
+                                header->channelCapacity) +
+        (cycle % header->ringSize) * shmCycleSize(header->channelCapacity));
+}
+
+inline ChannelReading* shmCycleReadings(ShmCycle* cycle)
+{
+    return reinterpret_cast<ChannelReading*>(cycle + 1);
+}
+
+#endif // TAKING_THE_TEMPERATURE_SHMLAYOUT_H
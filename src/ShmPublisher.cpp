@@ -0,0 +1,203 @@
+// C includes
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// STD includes
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+// Third parties includes
+#include <boost/format.hpp>
+
+// Local includes
+#include "ShmPublisher.h"
+
+using namespace std;
+
+ShmPublisher::ShmPublisher(string name, uint32_t channelCapacity,
+                           uint32_t ringSize)
+    : name(move(name))
+{
+    if (channelCapacity == 0 || ringSize == 0)
+        throw invalid_argument(
+            "Shared memory channel capacity and ring size should be "
+            "strictly positive.");
+
+    segmentSize = shmSegmentSize(channelCapacity, ringSize);
+    // A segment left by a previous publisher may still be mapped by readers:
+    // it is never truncated. With the same layout, it is reinitialised in
+    // place; otherwise it is unlinked and readers keep their stale mapping.
+    int fd = shm_open(this->name.c_str(), O_CREAT | O_RDWR, 0644);
+    struct stat status = {};
+    if (fd != -1 && fstat(fd, &status) == 0 && status.st_size != 0 &&
+        (size_t)status.st_size != segmentSize)
+    {
+        close(fd);
+        shm_unlink(this->name.c_str());
+        fd = shm_open(this->name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        status.st_size = 0;
+    }
+    if (fd == -1 ||
+        (status.st_size == 0 && ftruncate(fd, (off_t)segmentSize) == -1))
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to create shared memory %1%: %2%") %
+                this->name % strerror(errno));
+        if (fd != -1)
+            close(fd);
+        throw runtime_error(errorMessage);
+    }
+    segment =
+        mmap(nullptr, segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (segment == MAP_FAILED)
+    {
+        shm_unlink(this->name.c_str());
+        const string errorMessage =
+            str(boost::format("Impossible to map shared memory %1%.") %
+                this->name);
+        throw runtime_error(errorMessage);
+    }
+
+    if (status.st_size == 0)
+        initialise(channelCapacity, ringSize);
+    else
+        reinitialise(channelCapacity, ringSize);
+}
+
+void ShmPublisher::initialise(uint32_t channelCapacity, uint32_t ringSize)
+{
+    // The segment is zero filled, atomics are constructed in place.
+    auto* header = new (segment) ShmHeader();
+    header->version = SHM_VERSION;
+    header->channelCapacity = channelCapacity;
+    header->ringSize = ringSize;
+    header->segmentSize = segmentSize;
+    header->latestCycle.store(0, memory_order_relaxed);
+    header->cycleFutex.store(0, memory_order_relaxed);
+    header->sequence.store(0, memory_order_relaxed);
+    ShmChannel* channels = shmChannels(segment);
+    for (uint32_t c = 0; c < channelCapacity; c++)
+        new (&channels[c]) ShmChannel();
+    for (uint32_t r = 0; r < ringSize; r++)
+        new (shmCycle(segment, r)) ShmCycle();
+    header->magic.store(SHM_MAGIC, memory_order_release);
+}
+
+void ShmPublisher::reinitialise(uint32_t channelCapacity, uint32_t ringSize)
+{
+    // Same size as the layout: the atomics of the previous publisher are
+    // reused, so that the sequences of mapped readers keep moving forward.
+    auto* header = static_cast<ShmHeader*>(segment);
+    const uint32_t sequence = header->sequence.load(memory_order_relaxed);
+    header->sequence.store(sequence | 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    header->version = SHM_VERSION;
+    header->channelCapacity = channelCapacity;
+    header->ringSize = ringSize;
+    header->segmentSize = segmentSize;
+    header->latestCycle.store(0, memory_order_relaxed);
+
+    ShmChannel* channels = shmChannels(segment);
+    for (uint32_t c = 0; c < channelCapacity; c++)
+    {
+        ShmChannel& channel = channels[c];
+        const uint32_t before = channel.sequence.load(memory_order_relaxed);
+        channel.sequence.store(before | 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        channel.valid = 0;
+        channel.cycle = 0;
+        channel.timestampNs = 0;
+        channel.sequence.store((before | 1) + 1, memory_order_release);
+    }
+    for (uint32_t r = 0; r < ringSize; r++)
+    {
+        ShmCycle* cycle = shmCycle(segment, r);
+        const uint32_t before = cycle->sequence.load(memory_order_relaxed);
+        cycle->sequence.store(before | 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        cycle->readingCount = 0;
+        cycle->cycle = 0;
+        cycle->timestampNs = 0;
+        cycle->sequence.store((before | 1) + 1, memory_order_release);
+    }
+
+    header->magic.store(SHM_MAGIC, memory_order_relaxed);
+    header->sequence.store((sequence | 1) + 1, memory_order_release);
+    // Waiting readers are woken and see the cycle count restart. The futex
+    // word keeps holding the low 32 bits of latestCycle, as in publish().
+    header->cycleFutex.store(0, memory_order_release);
+    syscall(SYS_futex, &header->cycleFutex, FUTEX_WAKE, INT_MAX, nullptr,
+            nullptr, 0);
+}
+
+ShmPublisher::~ShmPublisher()
+{
+    munmap(segment, segmentSize);
+    shm_unlink(name.c_str());
+}
+
+void ShmPublisher::publish(const SweepSnapshot& snapshot)
+{
+    auto* header = static_cast<ShmHeader*>(segment);
+    const uint32_t capacity = header->channelCapacity;
+    // Readings are sorted by hardware Id: the last one bounds them all.
+    if (!snapshot.readings.empty() &&
+        snapshot.readings.back().hardwareId >= capacity)
+    {
+        const string errorMessage =
+            str(boost::format("Hardware Id %1% is beyond the %2% channels of "
+                              "segment %3%.") %
+                snapshot.readings.back().hardwareId % capacity % name);
+        throw invalid_argument(errorMessage);
+    }
+
+    // Channel table, channels missing from the sweep are invalidated.
+    ShmChannel* channels = shmChannels(segment);
+    auto reading = snapshot.readings.begin();
+    for (uint32_t c = 0; c < capacity; c++)
+    {
+        ShmChannel& channel = channels[c];
+        const bool valid =
+            reading != snapshot.readings.end() && reading->hardwareId == c;
+        if (!valid && channel.valid == 0)
+            continue;
+
+        const uint32_t sequence = channel.sequence.load(memory_order_relaxed);
+        channel.sequence.store(sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        channel.valid = valid;
+        channel.cycle = snapshot.cycle;
+        channel.timestampNs = snapshot.timestampNs;
+        if (valid)
+            channel.reading = *reading++;
+        channel.sequence.store(sequence + 2, memory_order_release);
+    }
+
+    // Ring of recent cycles.
+    ShmCycle* cycle = shmCycle(segment, snapshot.cycle);
+    ChannelReading* readings = shmCycleReadings(cycle);
+    const uint32_t sequence = cycle->sequence.load(memory_order_relaxed);
+    cycle->sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    cycle->cycle = snapshot.cycle;
+    cycle->timestampNs = snapshot.timestampNs;
+    cycle->readingCount = 0;
+    for (const auto& r : snapshot.readings)
+        readings[cycle->readingCount++] = r;
+    cycle->sequence.store(sequence + 2, memory_order_release);
+
+    header->latestCycle.store(snapshot.cycle, memory_order_release);
+    header->cycleFutex.store((uint32_t)snapshot.cycle, memory_order_release);
+    syscall(SYS_futex, &header->cycleFutex, FUTEX_WAKE, INT_MAX, nullptr,
+            nullptr, 0);
+}
+
+const string& ShmPublisher::getName() const { return name; }
@@ -0,0 +1,64 @@
+#ifndef TAKING_THE_TEMPERATURE_SHMPUBLISHER_H
+#define TAKING_THE_TEMPERATURE_SHMPUBLISHER_H
+
+// STD includes
+#include <cstdint>
+#include <string>
+
+// Local includes
+#include "ShmLayout.h"
+#include "SweepPublisher.h"
+#include "tmod.h"
+
+using namespace std;
+
+constexpr uint32_t SHM_DEFAULT_RING_SIZE = 16;
+
+/**
+ * @brief Publish the sweeps into a POSIX shared-memory segment.
+ * The segment holds the latest reading of each channel and a ring of the
+ * recent cycles, see ShmLayout.h. Readers map it read-only with ShmClient,
+ * and are woken through a futex at each cycle.
+ */
+class ShmPublisher : public SweepPublisher
+{
+public:
+    /**
+     * @param name: name of the segment, e.g. "/ttt_crate1".
+     * @param channelCapacity: number of channels of the table, hardware Ids
+     * should be lower. By default, the Adcs of the installed tmod backend.
+     * @param ringSize: number of recent cycles kept.
+     * @throw invalid_argument: if the sizes are 0.
+     * @throw runtime_error: if the segment cannot be created.
+     */
+    explicit ShmPublisher(string name,
+                          uint32_t channelCapacity = tmodMaxAdcs(),
+                          uint32_t ringSize = SHM_DEFAULT_RING_SIZE);
+
+    //! Unmap and unlink the segment.
+    ~ShmPublisher() override;
+
+    ShmPublisher(const ShmPublisher&) = delete;
+    ShmPublisher& operator=(const ShmPublisher&) = delete;
+
+    /**
+     * @brief Publish a sweep and wake the waiting readers.
+     * @throw invalid_argument: if a hardware Id is beyond the channel
+     * capacity. Nothing is published.
+     */
+    void publish(const SweepSnapshot& snapshot) override;
+
+    [[nodiscard]] const string& getName() const;
+
+private:
+    string name;
+    void* segment = nullptr;
+    size_t segmentSize = 0;
+
+    /// Initialise a new, zero-filled segment.
+    void initialise(uint32_t channelCapacity, uint32_t ringSize);
+    /// Reinitialise a segment of a previous publisher, under sequence locks.
+    void reinitialise(uint32_t channelCapacity, uint32_t ringSize);
+};
+
+#endif // TAKING_THE_TEMPERATURE_SHMPUBLISHER_H
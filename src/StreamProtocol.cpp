@@ -0,0 +1,109 @@
+// STD includes
+#include <cstring>
+
+// Local includes
+#include "StreamProtocol.h"
+
+using namespace std;
+
+namespace
+{
+template <typename T>
+void append(string& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool extract(const char*& payload, const char* end, T& value)
+{
+    if (end - payload < (ptrdiff_t)sizeof(T))
+        return false;
+    memcpy(&value, payload, sizeof(T));
+    payload += sizeof(T);
+    return true;
+}
+
+/**
+ * Write the payload length in front of a frame started at frameStart.
+ */
+void closeFrame(string& frame, size_t frameStart)
+{
+    const auto length =
+        (uint32_t)(frame.size() - frameStart - STREAM_LENGTH_SIZE);
+    memcpy(&frame[frameStart], &length, sizeof(length));
+}
+} // namespace
+
+void encodeSubscribe(const StreamSubscription& subscription, string& frame)
+{
+    const size_t frameStart = frame.size();
+    append(frame, (uint32_t)0);
+    append(frame, STREAM_SUBSCRIBE);
+    append(frame, subscription.decimation);
+    append(frame, (uint16_t)subscription.channels.size());
+    for (uint16_t channel : subscription.channels)
+        append(frame, channel);
+    closeFrame(frame, frameStart);
+}
+
+bool decodeSubscribe(const char* payload, size_t size,
+                     StreamSubscription& subscription)
+{
+    const char* end = payload + size;
+    uint8_t type = 0;
+    uint16_t channelCount = 0;
+    if (!extract(payload, end, type) || type != STREAM_SUBSCRIBE ||
+        !extract(payload, end, subscription.decimation) ||
+        !extract(payload, end, channelCount) ||
+        end - payload != channelCount * (ptrdiff_t)sizeof(uint16_t) ||
+        subscription.decimation == 0)
+        return false;
+
+    subscription.channels.resize(channelCount);
+    for (auto& channel : subscription.channels)
+        extract(payload, end, channel);
+    return true;
+}
+
+void encodeSweep(const SweepSnapshot& snapshot, const vector<bool>& channels,
+                 string& frame)
+{
+    const size_t frameStart = frame.size();
+    append(frame, (uint32_t)0);
+    append(frame, STREAM_SWEEP);
+    append(frame, snapshot.cycle);
+    append(frame, snapshot.timestampNs);
+    const size_t countOffset = frame.size();
+    append(frame, (uint16_t)0);
+
+    uint16_t count = 0;
+    for (const auto& reading : snapshot.readings)
+    {
+        if (!channels.empty() && (reading.hardwareId >= channels.size() ||
+                                  !channels[reading.hardwareId]))
+            continue;
+        append(frame, reading);
+        count++;
+    }
+    memcpy(&frame[countOffset], &count, sizeof(count));
+    closeFrame(frame, frameStart);
+}
+
+bool decodeSweep(const char* payload, size_t size, SweepSnapshot& snapshot)
+{
+    const char* end = payload + size;
+    uint8_t type = 0;
+    uint16_t count = 0;
+    if (!extract(payload, end, type) || type != STREAM_SWEEP ||
+        !extract(payload, end, snapshot.cycle) ||
+        !extract(payload, end, snapshot.timestampNs) ||
+        !extract(payload, end, count) ||
+        end - payload != count * (ptrdiff_t)sizeof(ChannelReading))
+        return false;
+
+    snapshot.readings.resize(count);
+    for (auto& reading : snapshot.readings)
+        extract(payload, end, reading);
+    return true;
+}
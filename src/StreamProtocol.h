@@ -0,0 +1,75 @@
+#ifndef TAKING_THE_TEMPERATURE_STREAMPROTOCOL_H
+#define TAKING_THE_TEMPERATURE_STREAMPROTOCOL_H
+
+// STD includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Local includes
+#include "SweepPublisher.h"
+
+using namespace std;
+
+/**
+ * Wire format of the live streams, in host byte order.
+ * Every message is a frame: uint32 payload length, then the payload, whose
+ * first byte is the message type.
+ *
+ * SUBSCRIBE, client to server:
+ *   uint8 type, uint16 decimation, uint16 channel count, uint16 channels[]
+ *   A decimation of N sends one sweep out of N, no channel means all of
+ *   them. A new subscription replaces the previous one.
+ *
+ * SWEEP, server to client:
+ *   uint8 type, uint64 cycle, int64 timestamp [ns], uint16 reading count,
+ *   ChannelReading readings[]
+ */
+
+enum StreamMessageType : uint8_t
+{
+    STREAM_SUBSCRIBE = 1, /**< Subscription request */
+    STREAM_SWEEP = 2      /**< Readings of a sweep */
+};
+
+//! Size of the length prefix of a frame.
+constexpr size_t STREAM_LENGTH_SIZE = sizeof(uint32_t);
+//! Largest payload accepted from a client.
+constexpr uint32_t STREAM_MAX_REQUEST_SIZE = 1 + 2 + 2 + 2 * UINT16_MAX;
+
+struct StreamSubscription
+{
+    uint16_t decimation = 1;
+    //! Subscribed hardware Ids, empty for all of them.
+    vector<uint16_t> channels;
+};
+
+/**
+ * @brief Append a SUBSCRIBE frame.
+ */
+void encodeSubscribe(const StreamSubscription& subscription, string& frame);
+
+/**
+ * @brief Decode a SUBSCRIBE payload, length prefix excluded.
+ * @return false if the payload is not a valid subscription.
+ */
+bool decodeSubscribe(const char* payload, size_t size,
+                     StreamSubscription& subscription);
+
+/**
+ * @brief Append a SWEEP frame.
+ * @param snapshot: readings of the sweep.
+ * @param channels: channels to send, indexed by hardware Id. All the
+ * readings are sent if empty.
+ * @param frame: buffer the frame is appended to.
+ */
+void encodeSweep(const SweepSnapshot& snapshot, const vector<bool>& channels,
+                 string& frame);
+
+/**
+ * @brief Decode a SWEEP payload, length prefix excluded.
+ * @return false if the payload is not a valid sweep.
+ */
+bool decodeSweep(const char* payload, size_t size, SweepSnapshot& snapshot);
+
+#endif // TAKING_THE_TEMPERATURE_STREAMPROTOCOL_H
@@ -0,0 +1,392 @@
+// C includes
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// STD includes
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+// Third parties includes
+#include <boost/format.hpp>
+
+// Local includes
+#include "StreamServer.h"
+
+using namespace std;
+
+namespace
+{
+constexpr int MAX_EVENTS = 64;
+constexpr size_t READ_SIZE = 4096;
+
+const vector<bool> ALL_CHANNELS;
+
+/**
+ * Key of the epoll events of a connection: its number and its fd. An event
+ * of a closed connection never matches a newer one reusing the same fd, even
+ * within the same epoll_wait batch.
+ */
+uint64_t clientKey(uint32_t connection, int fd)
+{
+    return (uint64_t)connection << 32 | (uint32_t)fd;
+}
+
+int keyFd(uint64_t key) { return (int)(uint32_t)key; }
+} // namespace
+
+StreamServer::StreamServer(string socketPath, StreamServerConfig config)
+    : socketPath(move(socketPath)), config(config)
+{
+    if (config.mailboxSize == 0)
+        throw invalid_argument("Mailbox size should be strictly positive.");
+
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (this->socketPath.size() >= sizeof(address.sun_path))
+    {
+        const string errorMessage =
+            str(boost::format("Socket path %1% is too long.") %
+                this->socketPath);
+        throw invalid_argument(errorMessage);
+    }
+    strcpy(address.sun_path, this->socketPath.c_str());
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    epollFd = epoll_create1(EPOLL_CLOEXEC);
+    eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    unlink(this->socketPath.c_str());
+    epoll_event listenEvent = {};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.u64 = clientKey(0, listenFd);
+    epoll_event wakeEvent = {};
+    wakeEvent.events = EPOLLIN;
+    wakeEvent.data.u64 = clientKey(0, eventFd);
+    if (listenFd == -1 || epollFd == -1 || eventFd == -1 ||
+        bind(listenFd, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) == -1 ||
+        listen(listenFd, SOMAXCONN) == -1 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &listenEvent) == -1 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, eventFd, &wakeEvent) == -1)
+    {
+        const string errorMessage =
+            str(boost::format("Impossible to serve on %1%: %2%") %
+                this->socketPath % strerror(errno));
+        closeAll();
+        throw runtime_error(errorMessage);
+    }
+
+    mailbox.resize(config.mailboxSize);
+    serverThread = thread(&StreamServer::run, this);
+}
+
+StreamServer::~StreamServer()
+{
+    stopping.store(true);
+    const uint64_t wake = 1;
+    [[maybe_unused]] ssize_t written = write(eventFd, &wake, sizeof(wake));
+    serverThread.join();
+
+    while (!clients.empty())
+        closeClient(clients.begin()->first);
+    closeAll();
+    unlink(socketPath.c_str());
+}
+
+void StreamServer::publish(const SweepSnapshot& snapshot)
+{
+    const uint64_t tail = mailboxTail.load(memory_order_relaxed);
+    if (tail - mailboxHead.load(memory_order_acquire) >= mailbox.size())
+    {
+        droppedSweepCount++;
+        return;
+    }
+
+    SweepSnapshot& slot = mailbox[tail % mailbox.size()];
+    slot.cycle = snapshot.cycle;
+    slot.timestampNs = snapshot.timestampNs;
+    slot.readings.assign(snapshot.readings.begin(), snapshot.readings.end());
+    mailboxTail.store(tail + 1, memory_order_release);
+
+    // Never blocks, the eventfd counter only saturates after 2^64 - 2.
+    const uint64_t wake = 1;
+    [[maybe_unused]] ssize_t written = write(eventFd, &wake, sizeof(wake));
+}
+
+size_t StreamServer::getSubscriberCount() const { return subscriberCount; }
+
+size_t StreamServer::getSlowConsumerCount() const
+{
+    return slowConsumerCount;
+}
+
+size_t StreamServer::getDroppedSweepCount() const
+{
+    return droppedSweepCount;
+}
+
+const string& StreamServer::getSocketPath() const { return socketPath; }
+
+void StreamServer::run()
+{
+    epoll_event events[MAX_EVENTS];
+    while (!stopping.load())
+    {
+        const int count = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        for (int i = 0; i < count; i++)
+        {
+            const uint64_t key = events[i].data.u64;
+            const int fd = keyFd(key);
+            if (key == clientKey(0, listenFd))
+            {
+                acceptClients();
+                continue;
+            }
+            if (key == clientKey(0, eventFd))
+            {
+                uint64_t wakes;
+                [[maybe_unused]] ssize_t readSize =
+                    read(eventFd, &wakes, sizeof(wakes));
+                dispatchSweeps();
+                continue;
+            }
+
+            // The client may have been closed by a previous event, and its fd
+            // reused by a new connection.
+            auto client = clients.find(fd);
+            if (client == clients.end() || client->second.key != key)
+                continue;
+            if ((events[i].events & EPOLLIN) != 0 &&
+                !readClient(client->second))
+                continue;
+            if ((events[i].events & (EPOLLERR | EPOLLHUP)) != 0)
+            {
+                closeClient(fd);
+                continue;
+            }
+            if ((events[i].events & EPOLLOUT) != 0)
+                flushClient(client->second);
+        }
+    }
+}
+
+void StreamServer::acceptClients()
+{
+    while (true)
+    {
+        const int fd =
+            accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1)
+            return;
+        if (clients.size() >= config.maxClients)
+        {
+            close(fd);
+            continue;
+        }
+        if (config.socketBufferSize > 0)
+            setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &config.socketBufferSize,
+                       sizeof(config.socketBufferSize));
+
+        // Connection numbers start at 1, 0 is for the server fds.
+        if (++connectionCount == 0)
+            connectionCount = 1;
+        const uint64_t key = clientKey(connectionCount, fd);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = key;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) == -1)
+        {
+            close(fd);
+            continue;
+        }
+        Client& client = clients[fd];
+        client.fd = fd;
+        client.key = key;
+    }
+}
+
+bool StreamServer::readClient(Client& client)
+{
+    char buffer[READ_SIZE];
+    while (true)
+    {
+        const ssize_t size = recv(client.fd, buffer, sizeof(buffer), 0);
+        // Requests are parsed as they come: the input never holds more than
+        // one incomplete request, of bounded size, plus one read.
+        if (size > 0)
+        {
+            client.input.append(buffer, (size_t)size);
+            if (!parseRequests(client))
+                return false;
+            continue;
+        }
+        if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return true;
+        // Disconnected or failed.
+        closeClient(client.fd);
+        return false;
+    }
+}
+
+bool StreamServer::parseRequests(Client& client)
+{
+    size_t offset = 0;
+    while (client.input.size() - offset >= STREAM_LENGTH_SIZE)
+    {
+        uint32_t length;
+        memcpy(&length, &client.input[offset], sizeof(length));
+        if (length > STREAM_MAX_REQUEST_SIZE)
+        {
+            closeClient(client.fd);
+            return false;
+        }
+        if (client.input.size() - offset - STREAM_LENGTH_SIZE < length)
+            break;
+
+        StreamSubscription subscription;
+        if (!decodeSubscribe(&client.input[offset + STREAM_LENGTH_SIZE],
+                             length, subscription))
+        {
+            closeClient(client.fd);
+            return false;
+        }
+        offset += STREAM_LENGTH_SIZE + length;
+
+        if (!client.subscribed)
+            subscriberCount++;
+        client.subscribed = true;
+        client.decimation = subscription.decimation;
+        client.sweepCount = 0;
+        client.channels.clear();
+        for (uint16_t channel : subscription.channels)
+        {
+            if (channel >= client.channels.size())
+                client.channels.resize(channel + 1, false);
+            client.channels[channel] = true;
+        }
+    }
+    client.input.erase(0, offset);
+    return true;
+}
+
+void StreamServer::dispatchSweeps()
+{
+    vector<int> slowConsumers;
+    uint64_t head = mailboxHead.load(memory_order_relaxed);
+    const uint64_t tail = mailboxTail.load(memory_order_acquire);
+    for (; head < tail; head++)
+    {
+        const SweepSnapshot& sweep = mailbox[head % mailbox.size()];
+        allChannelsFrame.clear();
+        for (auto& [fd, client] : clients)
+        {
+            if (!client.subscribed ||
+                client.sweepCount++ % client.decimation != 0)
+                continue;
+
+            if (client.channels.empty())
+            {
+                if (allChannelsFrame.empty())
+                    encodeSweep(sweep, ALL_CHANNELS, allChannelsFrame);
+                client.output += allChannelsFrame;
+            }
+            else
+                encodeSweep(sweep, client.channels, client.output);
+
+            if (client.output.size() - client.outputOffset >
+                config.maxQueuedBytes)
+                slowConsumers.push_back(fd);
+        }
+        // The slot can be reused by publish() from now on.
+        mailboxHead.store(head + 1, memory_order_release);
+    }
+
+    // A slow consumer may appear once per dispatched sweep.
+    for (int fd : slowConsumers)
+    {
+        if (clients.count(fd) == 0)
+            continue;
+        slowConsumerCount++;
+        closeClient(fd);
+    }
+
+    for (auto it = clients.begin(); it != clients.end();)
+    {
+        Client& client = (it++)->second;
+        if (!client.waitingWritable &&
+            client.outputOffset < client.output.size())
+            flushClient(client);
+    }
+}
+
+bool StreamServer::flushClient(Client& client)
+{
+    while (client.outputOffset < client.output.size())
+    {
+        const ssize_t size =
+            send(client.fd, client.output.data() + client.outputOffset,
+                 client.output.size() - client.outputOffset, MSG_NOSIGNAL);
+        if (size > 0)
+        {
+            client.outputOffset += (size_t)size;
+            continue;
+        }
+        if (size == -1 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            // Wait for the socket to drain, keeping the queue compact.
+            if (client.outputOffset > client.output.size() / 2)
+            {
+                client.output.erase(0, client.outputOffset);
+                client.outputOffset = 0;
+            }
+            if (!client.waitingWritable)
+            {
+                epoll_event event = {};
+                event.events = EPOLLIN | EPOLLOUT;
+                event.data.u64 = client.key;
+                epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+                client.waitingWritable = true;
+            }
+            return true;
+        }
+        closeClient(client.fd);
+        return false;
+    }
+
+    client.output.clear();
+    client.outputOffset = 0;
+    if (client.waitingWritable)
+    {
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.u64 = client.key;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, client.fd, &event);
+        client.waitingWritable = false;
+    }
+    return true;
+}
+
+void StreamServer::closeClient(int fd)
+{
+    auto client = clients.find(fd);
+    if (client == clients.end())
+        return;
+    if (client->second.subscribed)
+        subscriberCount--;
+    epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    clients.erase(client);
+}
+
+void StreamServer::closeAll()
+{
+    for (int* fd : {&listenFd, &epollFd, &eventFd})
+    {
+        if (*fd != -1)
+            close(*fd);
+        *fd = -1;
+    }
+}
@@ -0,0 +1,129 @@
+#ifndef TAKING_THE_TEMPERATURE_STREAMSERVER_H
+#define TAKING_THE_TEMPERATURE_STREAMSERVER_H
+
+// STD includes
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Local includes
+#include "StreamProtocol.h"
+#include "SweepPublisher.h"
+
+using namespace std;
+
+struct StreamServerConfig
+{
+    //! Bytes queued for a subscriber before it is disconnected.
+    size_t maxQueuedBytes = 1024 * 1024;
+    //! Connections refused beyond this count.
+    size_t maxClients = 1024;
+    //! Sweeps handed over to the server thread and not yet sent.
+    size_t mailboxSize = 16;
+    //! Kernel send buffer of the connections, 0 for the system default.
+    int socketBufferSize = 0;
+};
+
+/**
+ * @brief Streaming server of the sweeps over a Unix domain socket.
+ * Clients connect, send a subscription and receive the matching sweeps,
+ * see StreamProtocol.h. A single thread serves every client with epoll.
+ *
+ * publish() never blocks: the sweep is copied into a lock-free
+ * single-producer single-consumer mailbox and the server thread is woken
+ * through an eventfd. Sweeps are dropped when the mailbox is full. Each
+ * subscriber has its own bounded queue, and is disconnected when it does
+ * not keep up.
+ */
+class StreamServer : public SweepPublisher
+{
+public:
+    /**
+     * @param socketPath: path of the socket, replaced if it exists.
+     * @param config: limits of the server.
+     * @throw runtime_error: if the socket cannot be created.
+     */
+    explicit StreamServer(string socketPath, StreamServerConfig config = {});
+
+    //! Stop the server thread, close the connections, remove the socket.
+    ~StreamServer() override;
+
+    StreamServer(const StreamServer&) = delete;
+    StreamServer& operator=(const StreamServer&) = delete;
+
+    /**
+     * @brief Hand a sweep over to the server thread.
+     * Must always be called from the same thread.
+     */
+    void publish(const SweepSnapshot& snapshot) override;
+
+    /**
+     * @brief Get the number of clients with a subscription.
+     */
+    [[nodiscard]] size_t getSubscriberCount() const;
+
+    /**
+     * @brief Get the number of subscribers disconnected for being too slow.
+     */
+    [[nodiscard]] size_t getSlowConsumerCount() const;
+
+    /**
+     * @brief Get the number of sweeps dropped because of a full mailbox.
+     */
+    [[nodiscard]] size_t getDroppedSweepCount() const;
+
+    [[nodiscard]] const string& getSocketPath() const;
+
+private:
+    struct Client
+    {
+        int fd = -1;
+        //! Key of the epoll events, see clientKey().
+        uint64_t key = 0;
+        bool subscribed = false;
+        uint16_t decimation = 1;
+        uint64_t sweepCount = 0;
+        //! Subscribed channels, indexed by hardware Id. Empty for all.
+        vector<bool> channels;
+        string input;
+        string output;
+        size_t outputOffset = 0;
+        bool waitingWritable = false;
+    };
+
+    string socketPath;
+    StreamServerConfig config;
+    int listenFd = -1;
+    int epollFd = -1;
+    int eventFd = -1;
+    unordered_map<int, Client> clients;
+    /// Connections accepted so far.
+    uint32_t connectionCount = 0;
+
+    /// Mailbox slots, written by publish() and read by the server thread.
+    vector<SweepSnapshot> mailbox;
+    atomic<uint64_t> mailboxHead{0};
+    atomic<uint64_t> mailboxTail{0};
+
+    atomic<bool> stopping{false};
+    atomic<size_t> subscriberCount{0};
+    atomic<size_t> slowConsumerCount{0};
+    atomic<size_t> droppedSweepCount{0};
+    /// Encoded sweep shared by the subscribers to all the channels.
+    string allChannelsFrame;
+    thread serverThread;
+
+    void run();
+    void acceptClients();
+    bool readClient(Client& client);
+    bool parseRequests(Client& client);
+    void dispatchSweeps();
+    bool flushClient(Client& client);
+    void closeClient(int fd);
+    void closeAll();
+};
+
+#endif // TAKING_THE_TEMPERATURE_STREAMSERVER_H
@@ -0,0 +1,51 @@
+#ifndef TAKING_THE_TEMPERATURE_SWEEPPUBLISHER_H
+#define TAKING_THE_TEMPERATURE_SWEEPPUBLISHER_H
+
+// STD includes
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+/**
+ * @brief Reading of one channel during a sweep.
+ * Plain data with a fixed layout, so that it can be shared with other
+ * processes.
+ */
+struct ChannelReading
+{
+    uint16_t hardwareId;
+    int16_t adcValue;
+    float temperature;
+    float minTemperature;
+    float maxTemperature;
+};
+
+/**
+ * @brief Readings of all the channels of the VME system during one sweep.
+ */
+struct SweepSnapshot
+{
+    //! Sweep number, starting at 1.
+    uint64_t cycle = 0;
+    //! Time of the sweep, in ns since epoch.
+    int64_t timestampNs = 0;
+    //! Readings, sorted by hardware Id.
+    vector<ChannelReading> readings;
+};
+
+/**
+ * @brief Consumer of the sweeps of a VmeSystem.
+ * publish() is called on the acquisition thread at the end of each sweep,
+ * so it should return quickly.
+ * @see VmeSystem::addPublisher()
+ */
+class SweepPublisher
+{
+public:
+    virtual ~SweepPublisher() = default;
+
+    virtual void publish(const SweepSnapshot& snapshot) = 0;
+};
+
+#endif // TAKING_THE_TEMPERATURE_SWEEPPUBLISHER_H
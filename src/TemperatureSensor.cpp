@@ -1,5 +1,6 @@
 // STD includes
 #include <algorithm>
+#include <cmath>
 #include <stdexcept>
 
 // Third parties includes
@@ -19,11 +20,11 @@ TemperatureSensor::TemperatureSensor(uint16_t hardwareId, SensorType sensorType,
       scalingFactor(scalingFactor), offset(offset)
 {
     // Hardware Id cannot be negative, as an uint16.
-    if (this->hardwareId >= TMOD_MAX_ADCS)
+    if (this->hardwareId >= tmodMaxAdcs())
     {
         string errorMessage = str(
             boost::format("Hardware Id (%1%) should be between 0 and %2%.") %
-            hardwareId % TMOD_MAX_ADCS);
+            hardwareId % tmodMaxAdcs());
         throw invalid_argument(errorMessage);
     }
 }
@@ -44,22 +45,40 @@ void TemperatureSensor::convertAdcValue()
     maxTemperature = scalingFactor * (float)maxAdcValue + offset;
 }
 
-void TemperatureSensor::readAdcValue()
+int16_t TemperatureSensor::acquireAdcValue() const
 {
-    if (this->hardwareId >= TMOD_MAX_ADCS)
+    return tmodReadAdc(hardwareId);
+}
+
+bool TemperatureSensor::scheduleRead()
+{
+    if (adaptiveSampling.enabled && readsPerformed > 0 &&
+        ++cyclesSinceRead < readInterval)
     {
-        const string errorMessage =
-            str(boost::format(
-                    "Sensor hardware ID (%1%) is should be inferior to %2%.") %
-                hardwareId % TMOD_MAX_ADCS);
-        throw runtime_error(errorMessage);
+        readsSaved++;
+        return false;
     }
 
-    adcValue = tmodReadAdc(hardwareId);
+    cyclesSinceRead = 0;
+    readsPerformed++;
+    return true;
+}
+
+void TemperatureSensor::cancelRead(bool read, uint16_t previousCyclesSinceRead)
+{
+    if (read)
+        readsPerformed--;
+    else
+        readsSaved--;
+    cyclesSinceRead = previousCyclesSinceRead;
+}
+
+float TemperatureSensor::applyAdcValue(int16_t newAdcValue)
+{
+    adcValue = newAdcValue;
     minAdcValue = min(adcValue, minAdcValue);
     maxAdcValue = max(adcValue, maxAdcValue);
 
-
     if (adcValue > TMOD_MAX_ADC_VALUE)
     {
         const string errorMessage =
@@ -68,24 +87,36 @@ void TemperatureSensor::readAdcValue()
                 hardwareId % adcValue % TMOD_MAX_ADC_VALUE);
         throw runtime_error(errorMessage);
     }
-}
 
-float TemperatureSensor::measureTemperature()
-{
-    this->readAdcValue();
     this->convertAdcValue();
 
-    if (adcValue == -1)
+    if (adaptiveSampling.enabled)
     {
-        const string errorMessage =
-            str(boost::format(
-                    "No ADC reading has been made yet on sensor ID %1%.") %
-                hardwareId);
-        throw runtime_error(errorMessage);
+        if (fabs(temperature - referenceTemperature) > adaptiveSampling.band)
+        {
+            // Change detected, back to full rate.
+            referenceTemperature = temperature;
+            readInterval = 1;
+            steadyCount = 0;
+        }
+        else if (++steadyCount >= adaptiveSampling.steadyReads)
+        {
+            // Doubled in 32 bits, not to wrap beyond 32767 cycles.
+            readInterval = (uint16_t)min<uint32_t>(
+                (uint32_t)readInterval * 2, adaptiveSampling.maxStaleness);
+            steadyCount = 0;
+        }
     }
     return temperature;
 }
 
+float TemperatureSensor::measureTemperature()
+{
+    if (!scheduleRead())
+        return temperature;
+    return applyAdcValue(acquireAdcValue());
+}
+
 SensorType TemperatureSensor::getSensorType() const { return sensorType; }
 
 float TemperatureSensor::getScalingFactor() const { return scalingFactor; }
@@ -135,6 +166,9 @@ void TemperatureSensor::setScalingFactor(float newscalingFactor)
     if (scalingFactor != newscalingFactor)
     {
         scalingFactor = newscalingFactor;
+        // The steady band is in degrees, read again at the next cycle.
+        readInterval = 1;
+        steadyCount = 0;
         try
         {
             convertAdcValue();
@@ -152,6 +186,9 @@ void TemperatureSensor::setOffset(float newOffset)
     if (offset != newOffset)
     {
         offset = newOffset;
+        // The steady band is in degrees, read again at the next cycle.
+        readInterval = 1;
+        steadyCount = 0;
         try
         {
             convertAdcValue();
@@ -164,6 +201,46 @@ void TemperatureSensor::setOffset(float newOffset)
     }
 }
 
+void TemperatureSensor::setAdaptiveSampling(
+    const AdaptiveSamplingConfig& config)
+{
+    if (config.band < 0.f || config.steadyReads == 0 ||
+        config.maxStaleness == 0)
+    {
+        const string errorMessage =
+            str(boost::format("Invalid adaptive sampling for sensor ID %1%: "
+                              "band %2%, steady reads %3%, maximum staleness "
+                              "%4%.") %
+                hardwareId % config.band % config.steadyReads %
+                config.maxStaleness);
+        throw invalid_argument(errorMessage);
+    }
+
+    adaptiveSampling = config;
+    readInterval = 1;
+    steadyCount = 0;
+    referenceTemperature = temperature;
+}
+
+const AdaptiveSamplingConfig& TemperatureSensor::getAdaptiveSampling() const
+{
+    return adaptiveSampling;
+}
+
+uint64_t TemperatureSensor::getReadsSaved() const { return readsSaved; }
+
+uint64_t TemperatureSensor::getReadsPerformed() const
+{
+    return readsPerformed;
+}
+
+uint16_t TemperatureSensor::getReadInterval() const { return readInterval; }
+
+uint16_t TemperatureSensor::getCyclesSinceRead() const
+{
+    return cyclesSinceRead;
+}
+
 bool operator==(const TemperatureSensor& s1, const TemperatureSensor& s2)
 {
     return s1.getName() == s2.getName() &&
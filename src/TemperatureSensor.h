@@ -18,6 +18,25 @@ enum SensorType
     CURRENT_4MA_20MA = 1 /**< Current 4-20 mA */
 };
 
+/**
+ * @brief Change-driven sampling of a sensor.
+ * While the readings stay inside the band around the last change, the read
+ * interval doubles every steadyReads reads, up to maxStaleness cycles. It
+ * snaps back to every cycle as soon as a reading leaves the band. Skipped
+ * cycles return the last temperature.
+ */
+struct AdaptiveSamplingConfig
+{
+    //! Adaptive sampling is disabled by default, every cycle reads the Adc.
+    bool enabled = false;
+    //! Half width of the steady band [C].
+    float band = 0.5f;
+    //! Steady reads before the read interval doubles.
+    uint16_t steadyReads = 3;
+    //! Maximum number of cycles between two reads.
+    uint16_t maxStaleness = 8;
+};
+
 class TemperatureSensor
 {
 public:
@@ -29,10 +48,50 @@ public:
     /**
      * @brief Measure temperature.
      * Read Adc and convert measurement into temperature in degree Celsius.
+     * With adaptive sampling, the Adc may not be read and the last
+     * temperature is returned.
      * @return Temperature.
+     * @see setAdaptiveSampling()
      */
     float measureTemperature();
 
+    /**
+     * @brief Decide whether the Adc is read at the next cycle.
+     * First step of measureTemperature(), it advances the adaptive sampling
+     * by one cycle.
+     * @return false if the last temperature is to be reused.
+     */
+    bool scheduleRead();
+
+    /**
+     * @brief Cancel a decision of scheduleRead(), for a cycle dropped before
+     * being measured.
+     * Cycles are cancelled from the newest to the oldest.
+     * @param read: value returned by scheduleRead().
+     * @param previousCyclesSinceRead: getCyclesSinceRead() before the call
+     * to scheduleRead().
+     */
+    void cancelRead(bool read, uint16_t previousCyclesSinceRead);
+
+    /**
+     * @brief Read the Adc, without changing the sensor.
+     * Second step of measureTemperature(), the only one accessing the bus. It
+     * can run on another thread than the other steps.
+     * The hardware Id is not checked again, the constructor did.
+     * @return Raw Adc value.
+     */
+    [[nodiscard]] int16_t acquireAdcValue() const;
+
+    /**
+     * @brief Update the sensor with a new Adc value.
+     * Last step of measureTemperature(), converts the value and updates the
+     * statistics and the adaptive sampling.
+     * @param newAdcValue: value returned by acquireAdcValue().
+     * @return Temperature.
+     * @throw runtime_error: if the Adc value is too high.
+     */
+    float applyAdcValue(int16_t newAdcValue);
+
     /**
      * @brief Get the last temperature measurement, in degree Celsius.
      * @return Temperature [C]
@@ -110,6 +169,39 @@ public:
      */
     void setOffset(float offset);
 
+    /**
+     * @brief Set the adaptive sampling of the sensor.
+     * The next measurement reads the Adc.
+     * @throw invalid_argument: if the band is negative, or steadyReads or
+     * maxStaleness is 0.
+     */
+    void setAdaptiveSampling(const AdaptiveSamplingConfig& config);
+
+    /**
+     * @brief Get the adaptive sampling of the sensor.
+     */
+    [[nodiscard]] const AdaptiveSamplingConfig& getAdaptiveSampling() const;
+
+    /**
+     * @brief Get the number of measurements served without reading the Adc.
+     */
+    [[nodiscard]] uint64_t getReadsSaved() const;
+
+    /**
+     * @brief Get the number of Adc reads.
+     */
+    [[nodiscard]] uint64_t getReadsPerformed() const;
+
+    /**
+     * @brief Get the current number of cycles between two Adc reads.
+     */
+    [[nodiscard]] uint16_t getReadInterval() const;
+
+    /**
+     * @brief Get the number of cycles since the last Adc read.
+     */
+    [[nodiscard]] uint16_t getCyclesSinceRead() const;
+
     /**
      * @brief Compare two sensors.
      * It compares two sensors regarding its name, hardware address and
@@ -175,7 +267,18 @@ private:
      */
     float maxTemperature = -1e9f;
 
-    void readAdcValue();
+    //! Adaptive sampling settings.
+    AdaptiveSamplingConfig adaptiveSampling;
+    //! Cycles between two Adc reads.
+    uint16_t readInterval = 1;
+    //! Cycles since the last Adc read.
+    uint16_t cyclesSinceRead = 0;
+    //! Consecutive reads inside the steady band.
+    uint16_t steadyCount = 0;
+    //! Temperature at the last change [C].
+    float referenceTemperature = 0.f;
+    uint64_t readsSaved = 0;
+    uint64_t readsPerformed = 0;
 
     void convertAdcValue();
 };
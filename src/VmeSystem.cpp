@@ -1,13 +1,26 @@
+// C includes
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
 // STD includes
+#include <algorithm>
+#include <climits>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <string>
 #include <utility>
 
 // Third parties includes
+#include <boost/date_time/c_local_time_adjustor.hpp>
 #include <boost/date_time/posix_time/posix_time.hpp>
 #include <boost/format.hpp>
 #include <yaml-cpp/emitter.h>
 
 // Local includes
+#include "ReportFormat.h"
 #include "VmeSystem.h"
 
 using namespace boost::posix_time;
@@ -16,21 +29,98 @@ using namespace std;
 
 namespace io = boost::iostreams;
 
-VmeSystem::VmeSystem() { outputStream = &cout; }
+namespace
+{
+//! Size of a "2002-Jan-01 10:00:01" timestamp, with room to spare.
+constexpr size_t TIMESTAMP_SIZE = 32;
+
+/**
+ * Format a time like boost::posix_time::to_simple_string() does for whole
+ * seconds, without allocating.
+ * @return Size of the timestamp.
+ */
+size_t formatTimestamp(const ptime& time, char* timestamp)
+{
+    const auto date = time.date().year_month_day();
+    const auto timeOfDay = time.time_of_day();
+    const char* month = date.month.as_short_string();
+    const auto twoDigits = [](char* out, long value) {
+        out[0] = (char)('0' + value / 10 % 10);
+        out[1] = (char)('0' + value % 10);
+    };
+
+    char* out = timestamp;
+    out = to_chars(out, out + 5, (int)date.year).ptr;
+    *out++ = '-';
+    memcpy(out, month, 3);
+    out += 3;
+    *out++ = '-';
+    twoDigits(out, date.day);
+    out += 2;
+    *out++ = ' ';
+    twoDigits(out, timeOfDay.hours());
+    out += 2;
+    *out++ = ':';
+    twoDigits(out, timeOfDay.minutes());
+    out += 2;
+    *out++ = ':';
+    twoDigits(out, timeOfDay.seconds());
+    out += 2;
+    return (size_t)(out - timestamp);
+}
+
+void waitFutex(atomic<uint32_t>& word, uint32_t value)
+{
+    // Returns at once if the word changed since value was loaded.
+    syscall(SYS_futex, &word, FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+}
+
+void signalFutex(atomic<uint32_t>& word)
+{
+    word.fetch_add(1, memory_order_release);
+    syscall(SYS_futex, &word, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr,
+            0);
+}
+} // namespace
+
+VmeSystem::VmeSystem()
+{
+    outputStream = &cout;
+}
+
+VmeSystem::~VmeSystem()
+{
+    stopPipeline();
+}
 
 void VmeSystem::addSensor(uint16_t hardwareId, SensorType sensorType,
                           float scalingFactor, float offset, string name)
 {
+    if (isPipelineRunning())
+        throw runtime_error(
+            "Sensors cannot be added while the pipeline is running.");
 
     TemperatureSensor sensor(hardwareId, sensorType, scalingFactor, offset,
                              move(name));
 
+    // Keys and names are escaped once, the reports only copy them.
+    Emitter key;
+    key << std::to_string(sensor.getHardwareId()) + "-" + sensor.getName();
+    Emitter quotedName;
+    quotedName << sensor.getName();
+    reportLabels.insert(pair<uint16_t, ReportLabels>(
+        sensor.getHardwareId(), {key.c_str(), quotedName.c_str()}));
+
     temperatureSensors.insert(
         pair<uint16_t, TemperatureSensor>(sensor.getHardwareId(), sensor));
+    bindChannels();
 }
 
 void VmeSystem::removeSensor(uint16_t hardwareId)
 {
+    if (isPipelineRunning())
+        throw runtime_error(
+            "Sensors cannot be removed while the pipeline is running.");
     if (temperatureSensors.find(hardwareId) == temperatureSensors.end())
     {
         const string errorMessage =
@@ -40,7 +130,11 @@ void VmeSystem::removeSensor(uint16_t hardwareId)
         throw invalid_argument(errorMessage);
     }
     else
+    {
         temperatureSensors.erase(hardwareId);
+        reportLabels.erase(hardwareId);
+        bindChannels();
+    }
 }
 
 void VmeSystem::setScalingData(uint16_t hardwareId, float scalingFactor,
@@ -61,7 +155,64 @@ void VmeSystem::setScalingData(uint16_t hardwareId, float scalingFactor,
     }
 }
 
-void VmeSystem::setOutputStream(ostream* os) { outputStream = os; }
+void VmeSystem::setAdaptiveSampling(uint16_t hardwareId,
+                                    const AdaptiveSamplingConfig& config)
+{
+    if (temperatureSensors.find(hardwareId) == temperatureSensors.end())
+    {
+        const string errorMessage =
+            str(boost::format("No Temperature has previously been added to the "
+                              "hardware address %1%.") %
+                hardwareId);
+        throw invalid_argument(errorMessage);
+    }
+    else
+        temperatureSensors.at(hardwareId).setAdaptiveSampling(config);
+}
+
+void VmeSystem::setAdaptiveSampling(const AdaptiveSamplingConfig& config)
+{
+    for (auto& [unused, value] : temperatureSensors)
+    {
+        (void)unused; // unused variable
+        value.setAdaptiveSampling(config);
+    }
+}
+
+void VmeSystem::setOutputStream(ostream* os)
+{
+    outputStream = os;
+}
+
+void VmeSystem::setSummaryStream(ostream* out)
+{
+    summaryStream = out;
+}
+
+void VmeSystem::addChannelGroup(const ChannelGroup& group)
+{
+    aggregator.addGroup(group);
+}
+
+void VmeSystem::removeChannelGroup(const string& name)
+{
+    aggregator.removeGroup(name);
+}
+
+void VmeSystem::setFaultTolerance(bool enabled)
+{
+    faultTolerance = enabled;
+}
+
+void VmeSystem::setClock(Clock* newClock)
+{
+    if (newClock == nullptr)
+        throw invalid_argument("Clock is null.");
+    if (isPipelineRunning())
+        throw runtime_error(
+            "The clock cannot be changed while the pipeline is running.");
+    clock = newClock;
+}
 
 void VmeSystem::measureTemperaturesAndProduceReport()
 {
@@ -71,45 +222,372 @@ void VmeSystem::measureTemperaturesAndProduceReport()
         throw invalid_argument("Output stream is null.");
     }
 
-    Emitter out;
-    //    *outputStream << "Temperature sensors:";
-    auto currentTime = second_clock::local_time();
-    string currentTimeStr = to_simple_string(currentTime);
-    out << BeginMap;
-    out << Key << currentTimeStr << Value << BeginMap;
+    if (!isPipelineRunning())
+    {
+        schedule(serialCycle);
+        acquire(serialCycle);
+        if (serialCycle.error && !faultTolerance)
+            rethrow_exception(serialCycle.error);
+        produceReport(serialCycle);
+        return;
+    }
+
+    // Keep the bus busy: the buffer of the previous cycle is free again.
+    while (scheduledCycles.load(memory_order_relaxed) <
+           reportedCycles + cycles.size())
+        scheduleCycle();
+
+    while (true)
+    {
+        const uint32_t signal = processingSignal.load(memory_order_acquire);
+        if (acquiredCycles.load(memory_order_acquire) > reportedCycles)
+            break;
+        waitFutex(processingSignal, signal);
+    }
+    const AcquisitionCycle& cycle = cycles[reportedCycles % cycles.size()];
+    // Not rescheduled before the next call, even if the report throws.
+    reportedCycles++;
+    if (cycle.error && !faultTolerance)
+        rethrow_exception(cycle.error);
+    produceReport(cycle);
+}
+
+void VmeSystem::startPipeline(size_t cycleBuffers)
+{
+    if (cycleBuffers < 2)
+        throw invalid_argument("The pipeline needs at least 2 cycle buffers.");
+    if (isPipelineRunning())
+        throw runtime_error("The pipeline is already running.");
+
+    cycles.assign(cycleBuffers, AcquisitionCycle());
+    for (auto& cycle : cycles)
+        resetTables(cycle);
+    scheduledCycles.store(0);
+    acquiredCycles.store(0);
+    reportedCycles = 0;
+    pipelineStopping.store(false);
+    busThread = thread(&VmeSystem::runBus, this);
+}
+
+void VmeSystem::stopPipeline()
+{
+    if (!isPipelineRunning())
+        return;
+    pipelineStopping.store(true);
+    signalFutex(busSignal);
+    busThread.join();
+
+    // Cycles scheduled ahead are dropped: their reads never happened for
+    // the adaptive sampling.
+    for (uint64_t dropped = scheduledCycles.load(); dropped-- > reportedCycles;)
+    {
+        const AcquisitionCycle& cycle = cycles[dropped % cycles.size()];
+        size_t channel = 0;
+        for (auto& [unused, value] : temperatureSensors)
+        {
+            (void)unused; // unused variable
+            value.cancelRead(cycle.scheduled[channel],
+                             cycle.cyclesSinceRead[channel]);
+            channel++;
+        }
+    }
+}
+
+bool VmeSystem::isPipelineRunning() const
+{
+    return busThread.joinable();
+}
+
+void VmeSystem::scheduleCycle()
+{
+    const uint64_t scheduled = scheduledCycles.load(memory_order_relaxed);
+    schedule(cycles[scheduled % cycles.size()]);
+    scheduledCycles.store(scheduled + 1, memory_order_release);
+    signalFutex(busSignal);
+}
+
+void VmeSystem::schedule(AcquisitionCycle& cycle)
+{
+    size_t channel = 0;
     for (auto& [unused, value] : temperatureSensors)
     {
         (void)unused; // unused variable
-        out << Key
-            << std::to_string(value.getHardwareId()) + "-" + value.getName();
-        out << Value;
-        out << BeginMap;
-        out << Key << "Hardware Id";
-        out << Value << value.getHardwareId();
-        out << Key << "Name";
-        out << Value << value.getName();
-        out << Key << "Sensor type";
-        string sensorType = value.getSensorType() == SensorType::VOLTAGE_0V_10V
-                                ? "Voltage 0-10V"
-                                : "Current 4-20mA";
-        out << Value << sensorType;
-        out << Key << "Scaling factor";
-        out << Value << value.getScalingFactor();
-        out << Key << "Offset";
-        out << Value << value.getOffset();
-        out << Key << "Current time";
-        out << Value << currentTimeStr;
-        out << Key << "Temperature";
-        out << Value << value.measureTemperature();
-        out << Key << "Min temperature";
-        out << Value << value.getMinTemperature();
-        out << Key << "Max temperature";
-        out << Value << value.getMaxTemperature();
-        out << EndMap;
-    }
-    out << EndMap;
-    out << EndMap;
-    *outputStream << out.c_str() << "\n";
+        cycle.cyclesSinceRead[channel] = value.getCyclesSinceRead();
+        cycle.scheduled[channel] = value.scheduleRead();
+        channel++;
+    }
+}
+
+void VmeSystem::acquire(AcquisitionCycle& cycle)
+{
+    cycle.acquiredAt = clock->now();
+    cycle.error = nullptr;
+    const size_t channels = cycle.scheduled.size();
+    for (size_t channel = 0; channel < channels; channel++)
+        cycle.faulted[channel] = false;
+
+    // Hardware Ids were checked when the sensors were added: the sweep goes
+    // through the table without bounds checks. Errors are rare, the sweep is
+    // only left on an error, to be resumed after the faulted channel.
+    size_t channel = 0;
+    while (channel < channels)
+    {
+        try
+        {
+            for (; channel < channels; channel++)
+                if (cycle.scheduled[channel])
+                    cycle.adcValues[channel] = tmodReadAdc(channelIds[channel]);
+        }
+        catch (...)
+        {
+            // The other channels are still read, for the fault tolerance.
+            cycle.faulted[channel] = true;
+            if (!cycle.error)
+                cycle.error = current_exception();
+            channel++;
+        }
+    }
+}
+
+void VmeSystem::resetTables(AcquisitionCycle& cycle)
+{
+    const size_t channels = temperatureSensors.size();
+    cycle.scheduled.assign(channels, 0);
+    cycle.cyclesSinceRead.assign(channels, 0);
+    cycle.adcValues.assign(channels, 0);
+    cycle.faulted.assign(channels, 0);
+}
+
+void VmeSystem::runBus()
+{
+    uint64_t acquired = acquiredCycles.load(memory_order_relaxed);
+    while (true)
+    {
+        const uint32_t signal = busSignal.load(memory_order_acquire);
+        if (pipelineStopping.load())
+            return;
+        if (scheduledCycles.load(memory_order_acquire) == acquired)
+        {
+            waitFutex(busSignal, signal);
+            continue;
+        }
+
+        acquire(cycles[acquired % cycles.size()]);
+        acquiredCycles.store(++acquired, memory_order_release);
+        signalFutex(processingSignal);
+    }
+}
+
+void VmeSystem::produceReport(const AcquisitionCycle& cycle)
+{
+    const auto acquiredAt = cycle.acquiredAt;
+    // The report is formatted by hand into a buffer reused from one cycle to
+    // the next: once warmed up, a cycle does not allocate.
+    const ptime currentTime =
+        boost::date_time::c_local_adjustor<ptime>::utc_to_local(
+            from_time_t(chrono::system_clock::to_time_t(acquiredAt)));
+    sweep.cycle++;
+    sweep.timestampNs = chrono::duration_cast<chrono::nanoseconds>(
+                            acquiredAt.time_since_epoch())
+                            .count();
+    sweep.readings.clear();
+    char currentTimeStr[TIMESTAMP_SIZE];
+    const size_t currentTimeSize = formatTimestamp(currentTime, currentTimeStr);
+
+    report.clear();
+    report.append(currentTimeStr, currentTimeSize);
+    report += temperatureSensors.empty() ? ":\n  {}\n" : ":\n";
+    auto labels = reportLabels.cbegin();
+    size_t sensor = 0;
+    for (auto& [hardwareId, value] : temperatureSensors)
+    {
+        float temperature = NAN;
+        bool faulted = false;
+        try
+        {
+            if (cycle.faulted[sensor])
+                faulted = true;
+            else if (cycle.scheduled[sensor])
+                temperature = value.applyAdcValue(cycle.adcValues[sensor]);
+            else
+                temperature = value.getTemperature();
+        }
+        catch (const runtime_error&)
+        {
+            if (!faultTolerance)
+                throw;
+            faulted = true;
+        }
+        aggregator.record(sensor, temperature, faulted);
+        sensor++;
+
+        report += "  ";
+        report += labels->second.key;
+        report += ":\n    Hardware Id: ";
+        appendNumber(report, value.getHardwareId());
+        report += "\n    Name: ";
+        report += labels->second.name;
+        report += "\n    Sensor type: ";
+        report += value.getSensorType() == SensorType::VOLTAGE_0V_10V
+                      ? "Voltage 0-10V"
+                      : "Current 4-20mA";
+        report += "\n    Scaling factor: ";
+        appendNumber(report, value.getScalingFactor());
+        report += "\n    Offset: ";
+        appendNumber(report, value.getOffset());
+        report += "\n    Current time: ";
+        report.append(currentTimeStr, currentTimeSize);
+        if (faulted)
+            report += "\n    Status: Fault";
+        report += "\n    Temperature: ";
+        appendNumber(report, temperature);
+        report += "\n    Min temperature: ";
+        appendNumber(report, faulted ? NAN : value.getMinTemperature());
+        report += "\n    Max temperature: ";
+        appendNumber(report, faulted ? NAN : value.getMaxTemperature());
+        if (value.getAdaptiveSampling().enabled)
+        {
+            report += "\n    Reads saved: ";
+            appendNumber(report, value.getReadsSaved());
+        }
+        report += '\n';
+        ++labels;
+
+        if (faulted)
+            sweep.readings.push_back({value.getHardwareId(),
+                                      TMOD_INVALID_VOLTAGE_MEASUREMENT, NAN,
+                                      NAN, NAN});
+        else
+            sweep.readings.push_back(
+                {value.getHardwareId(), value.getAdcValue(),
+                 value.getTemperature(), value.getMinTemperature(),
+                 value.getMaxTemperature()});
+    }
+    // Headroom, so that a slightly longer report does not reallocate.
+    if (report.capacity() < report.size() + report.size() / 2)
+        report.reserve(2 * report.size());
+    // Flushing marks the end of the cycle for the report sink.
+    outputStream->write(report.data(), (streamsize)report.size());
+    outputStream->flush();
+    // A failed sink only sets the bad bit: it is cleared so that the next
+    // reports are still attempted, once the aggregates and publishers are
+    // served.
+    const bool reportLost = outputStream->bad();
+    if (reportLost)
+        outputStream->clear();
+
+    if (!aggregator.getGroups().empty())
+    {
+        aggregator.aggregate();
+        if (summaryStream != nullptr)
+            produceSummary(currentTimeStr, currentTimeSize);
+    }
+
+    for (auto publisher : publishers)
+        publisher->publish(sweep);
+
+    if (reportLost)
+        throw runtime_error("Impossible to write the report to the output "
+                            "stream.");
+}
+
+void VmeSystem::produceSummary(const char* timestamp, size_t timestampSize)
+{
+    // Missing values, with no healthy channel in the group.
+    const auto appendChannel = [this](uint16_t hardwareId) {
+        if (hardwareId == UINT16_MAX)
+            summary += '~';
+        else
+            appendNumber(summary, hardwareId);
+    };
+
+    summary.clear();
+    const auto& groups = aggregator.getGroups();
+    const auto& aggregates = aggregator.getAggregates();
+    for (size_t group = 0; group < groups.size(); group++)
+    {
+        const uint8_t metrics = groups[group].metrics;
+        const GroupAggregate& aggregate = aggregates[group];
+        summary += "- {Time: ";
+        summary.append(timestamp, timestampSize);
+        summary += ", Group: ";
+        summary += groups[group].name;
+        summary += ", Channels: ";
+        appendNumber(summary, aggregate.channels);
+        if (metrics & AGGREGATE_FAULTS)
+        {
+            summary += ", Faults: ";
+            appendNumber(summary, aggregate.faults);
+        }
+        if (metrics & AGGREGATE_MIN)
+        {
+            summary += ", Min: ";
+            appendNumber(summary, aggregate.min);
+            summary += ", Coldest: ";
+            appendChannel(aggregate.coldest);
+        }
+        if (metrics & AGGREGATE_MAX)
+        {
+            summary += ", Max: ";
+            appendNumber(summary, aggregate.max);
+            summary += ", Hottest: ";
+            appendChannel(aggregate.hottest);
+        }
+        if (metrics & AGGREGATE_MEAN)
+        {
+            summary += ", Mean: ";
+            appendNumber(summary, aggregate.mean);
+        }
+        if (metrics & AGGREGATE_SPREAD)
+        {
+            summary += ", Spread: ";
+            appendNumber(summary, aggregate.spread);
+        }
+        summary += "}\n";
+    }
+    if (summary.capacity() < summary.size() + summary.size() / 2)
+        summary.reserve(2 * summary.size());
+    summaryStream->write(summary.data(), (streamsize)summary.size());
+    summaryStream->flush();
+}
+
+void VmeSystem::bindChannels()
+{
+    channelIds.clear();
+    for (const auto& [hardwareId, unused] : temperatureSensors)
+    {
+        (void)unused; // unused variable
+        channelIds.push_back(hardwareId);
+    }
+    aggregator.bind(channelIds);
+    resetTables(serialCycle);
+}
+
+void VmeSystem::addPublisher(SweepPublisher* publisher)
+{
+    if (publisher == nullptr)
+    {
+        throw invalid_argument("Publisher is null.");
+    }
+    if (find(publishers.begin(), publishers.end(), publisher) ==
+        publishers.end())
+        publishers.push_back(publisher);
+}
+
+void VmeSystem::removePublisher(SweepPublisher* publisher)
+{
+    publishers.erase(remove(publishers.begin(), publishers.end(), publisher),
+                     publishers.end());
+}
+
+const SweepSnapshot& VmeSystem::getLastSweep() const
+{
+    return sweep;
+}
+
+const vector<GroupAggregate>& VmeSystem::getLastAggregates() const
+{
+    return aggregator.getAggregates();
 }
 
 const map<uint16_t, TemperatureSensor>& VmeSystem::getTemperatureSensors() const
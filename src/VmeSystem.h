@@ -2,25 +2,55 @@
 #define TAKING_THE_TEMPERATURE_VMESYSTEM_H
 
 // STD includes
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <iostream>
 #include <map>
+#include <string>
+#include <thread>
+#include <vector>
 
 // Third parties includes
 #include <boost/iostreams/device/file_descriptor.hpp>
 #include <boost/iostreams/stream_buffer.hpp>
 
 // Local includes
+#include "ChannelAggregator.h"
+#include "Clock.h"
+#include "SweepPublisher.h"
 #include "TemperatureSensor.h"
 
 namespace io = boost::iostreams;
 using namespace std;
 
+/**
+ * @brief Crate of temperature sensors.
+ *
+ * By default, each call to measureTemperaturesAndProduceReport() reads the
+ * sensors one after the other, then reports. With startPipeline(), the bus
+ * reads are made by a dedicated thread into a ring of cycle buffers, so that
+ * the acquisition of the next cycles overlaps with the conversion and the
+ * report of the current one.
+ *
+ * The crate holds as many channels as the tmod backend serves, see
+ * tmodMaxAdcs(). Sweeps are acquired into dense tables of one entry per
+ * sensor, in the order of the hardware Ids: hardware Ids are checked once,
+ * when the sensors are added, and the sweeps read the tables without bounds
+ * checks.
+ */
 class VmeSystem
 {
 public:
     //! Default constructor.
     VmeSystem();
 
+    //! Stop the pipeline, if running.
+    ~VmeSystem();
+
+    VmeSystem(const VmeSystem&) = delete;
+    VmeSystem& operator=(const VmeSystem&) = delete;
+
     /**
      * @brief Add a sensor to the VmeSystem.
      *
@@ -30,6 +60,9 @@ public:
      * temperature, optional.
      * @param offset: offset for the conversion to a temperature, optional.
      * @param name: name of the sensor, optional.
+     * @throw invalid_argument: if the hardware Id is beyond the Adcs of the
+     * tmod backend.
+     * @throw runtime_error: if the pipeline is running.
      */
     //!
     void addSensor(uint16_t hardwareId, SensorType sensorType,
@@ -40,6 +73,7 @@ public:
     /**
      * @brief Remove a sensor from the Vme system
      * @param hardwareId: the address of the ADC reading the sensor.
+     * @throw runtime_error: if the pipeline is running.
      */
     void removeSensor(uint16_t hardwareId);
 
@@ -52,18 +86,141 @@ public:
      */
     void setScalingData(uint16_t hardwareId, float scalingFactor, float offset);
 
+    /**
+     * @brief Set the adaptive sampling of a given sensor.
+     * The report of an adaptive sensor gets its count of reads saved.
+     * @param hardwareId: hardware address of the sensor.
+     * @param config: adaptive sampling settings.
+     * @throw invalid_argument: if no sensor is registered at this address, or
+     * if the settings are invalid.
+     */
+    void setAdaptiveSampling(uint16_t hardwareId,
+                             const AdaptiveSamplingConfig& config);
+
+    /**
+     * @brief Set the adaptive sampling of all the registered sensors.
+     * @throw invalid_argument: if the settings are invalid.
+     */
+    void setAdaptiveSampling(const AdaptiveSamplingConfig& config);
+
     /**
      * @brief Set the output stream for report generation.
+     * The stream is flushed after each report, which marks the end of a
+     * cycle for sinks such as ReportWriter.
      * @param out: point to the output stream.
      * @throw invalid_argument: if no sensor is registered at this address.
      */
     void setOutputStream(ostream* out);
 
+    /**
+     * @brief Set the output stream of the group summaries.
+     * Each cycle appends one flow-style record per group, e.g.
+     * "- {Time: 2021-Feb-09 20:55:51, Group: crate, Channels: 4, Faults: 0,
+     * Min: 20.5, Coldest: 3, Max: 31, Hottest: 1, Mean: 25.25, Spread: 10.5}",
+     * with the metrics selected for the group, then flushes the stream.
+     * @param out: summary stream, nullptr to disable the summaries.
+     */
+    void setSummaryStream(ostream* out);
+
+    /**
+     * @brief Add a group of channels, aggregated at each cycle.
+     * @param group: name, channels and metrics of the group.
+     * @throw invalid_argument: if the name is not valid or already used, if
+     * no sensor is registered at one of the addresses, or if no metric is
+     * selected.
+     */
+    void addChannelGroup(const ChannelGroup& group);
+
+    /**
+     * @brief Remove a group of channels.
+     * @throw invalid_argument: if no group has this name.
+     */
+    void removeChannelGroup(const string& name);
+
+    /**
+     * @brief Keep going when a sensor fails to read.
+     * By default, the error of a sensor is thrown and aborts the cycle. With
+     * fault tolerance, the sensor is reported with "Status: Fault" and NaN
+     * temperatures, it counts as a fault in the aggregates, and the other
+     * sensors are reported as usual.
+     * @param enabled: whether the faults are tolerated.
+     */
+    void setFaultTolerance(bool enabled);
+
+    /**
+     * @brief Set the clock time-stamping the cycles.
+     * The clock is not owned and should outlive the VmeSystem.
+     * @param clock: clock to use, the real clock by default.
+     * @throw invalid_argument: if clock is null.
+     * @throw runtime_error: if the pipeline is running.
+     */
+    void setClock(Clock* clock);
+
     /**
      * @brief Measure the temperatures and produce report.
+     * Once the buffers are warmed up by a first cycle, a cycle does not
+     * allocate as long as the sensors, the output stream and the publishers
+     * do not.
+     * When the pipeline is running, the report is the one of the oldest
+     * cycle acquired, time-stamped at the start of its acquisition.
+     * @throw runtime_error: if the output stream fails to write or flush
+     * the report. The sweep is still published, and the stream state is
+     * cleared for the next report.
      */
     void measureTemperaturesAndProduceReport();
 
+    /**
+     * @brief Acquire the cycles on a dedicated bus thread.
+     * Each call to measureTemperaturesAndProduceReport() first hands the
+     * next cycles over to the bus thread, up to cycleBuffers cycles in
+     * flight, then waits for the oldest one and reports it while the others
+     * are acquired. Cycles are acquired and reported in order, and the
+     * sensors are read in the same order as without pipeline. Reports lag
+     * the bus by up to cycleBuffers - 1 cycles, and so does the adaptive
+     * sampling.
+     * Sensors cannot be added or removed while the pipeline is running.
+     * @param cycleBuffers: number of cycle buffers, at least 2.
+     * @throw invalid_argument: if cycleBuffers is lower than 2.
+     * @throw runtime_error: if the pipeline is already running.
+     */
+    void startPipeline(size_t cycleBuffers = 2);
+
+    /**
+     * @brief Stop the bus thread.
+     * The cycles acquired ahead and not reported are dropped, and their
+     * adaptive sampling decisions undone.
+     */
+    void stopPipeline();
+
+    [[nodiscard]] bool isPipelineRunning() const;
+
+    /**
+     * @brief Register a consumer of the sweeps.
+     * It is given the readings at the end of each call to
+     * measureTemperaturesAndProduceReport(). The publisher is not owned and
+     * should outlive its registration.
+     * @param publisher: consumer to register.
+     */
+    void addPublisher(SweepPublisher* publisher);
+
+    /**
+     * @brief Unregister a consumer of the sweeps.
+     * @param publisher: consumer to unregister.
+     */
+    void removePublisher(SweepPublisher* publisher);
+
+    /**
+     * @brief Get the readings of the last sweep.
+     * @return Last sweep, with a cycle number of 0 before the first one.
+     */
+    [[nodiscard]] const SweepSnapshot& getLastSweep() const;
+
+    /**
+     * @brief Get the aggregates of the last cycle.
+     * @return Aggregates, in the order of the groups added.
+     */
+    [[nodiscard]] const vector<GroupAggregate>& getLastAggregates() const;
+
     /**
      * @brief Get a map of the registred sensors.
      * @return map of the registred sensors.
@@ -74,10 +231,82 @@ public:
     getTemperatureSensors() const;
 
 private:
+    /// YAML-escaped labels of a sensor in the reports.
+    struct ReportLabels
+    {
+        string key;
+        string name;
+    };
+
+    /// Buffer of a cycle, with tables indexed like channelIds.
+    struct AcquisitionCycle
+    {
+        //! Whether each channel is read, decided by the processing thread.
+        vector<uint8_t> scheduled;
+        //! Cycles since the last read of each sensor, before scheduling.
+        vector<uint16_t> cyclesSinceRead;
+        //! Raw values, written by the bus thread.
+        vector<int16_t> adcValues;
+        //! Whether each read failed, written by the bus thread.
+        vector<uint8_t> faulted;
+        chrono::system_clock::time_point acquiredAt;
+        //! First error raised by the bus, reported with the cycle.
+        exception_ptr error;
+    };
+
     /// Sensor temperatures.
     map<uint16_t, TemperatureSensor> temperatureSensors;
+    /// Hardware Id of each channel of the tables, in the order of the map.
+    vector<uint16_t> channelIds;
+    /// Report labels of the sensors, with the same keys.
+    map<uint16_t, ReportLabels> reportLabels;
+    /// Report of the current cycle, reused from one cycle to the next.
+    string report;
     /// Output stream.
     ostream* outputStream;
+    /// Clock time-stamping the cycles.
+    Clock* clock = &realClock();
+    /// Consumers of the sweeps.
+    vector<SweepPublisher*> publishers;
+    /// Readings of the last sweep, reused from one sweep to the next.
+    SweepSnapshot sweep;
+    /// Cycle buffer without pipeline.
+    AcquisitionCycle serialCycle{};
+    /// Aggregates of the channel groups.
+    ChannelAggregator aggregator;
+    /// Summary stream, none by default.
+    ostream* summaryStream = nullptr;
+    /// Summary of the current cycle, reused from one cycle to the next.
+    string summary;
+    bool faultTolerance = false;
+
+    /**
+     * Pipeline ring. Cycle c uses cycles[c % cycles.size()]. The processing
+     * thread fills scheduled then publishes the cycle with a release store
+     * of scheduledCycles; the bus thread fills the rest then publishes it
+     * with a release store of acquiredCycles. A buffer is only rescheduled
+     * once its previous cycle has been reported.
+     */
+    vector<AcquisitionCycle> cycles;
+    atomic<uint64_t> scheduledCycles{0};
+    atomic<uint64_t> acquiredCycles{0};
+    /// Cycles reported, only used by the processing thread.
+    uint64_t reportedCycles = 0;
+    /// Futex words, bumped when the bus thread, resp. the processing thread,
+    /// has something new to look at.
+    atomic<uint32_t> busSignal{0};
+    atomic<uint32_t> processingSignal{0};
+    atomic<bool> pipelineStopping{false};
+    thread busThread;
+
+    void scheduleCycle();
+    void schedule(AcquisitionCycle& cycle);
+    void acquire(AcquisitionCycle& cycle);
+    void resetTables(AcquisitionCycle& cycle);
+    void runBus();
+    void produceReport(const AcquisitionCycle& cycle);
+    void produceSummary(const char* timestamp, size_t timestampSize);
+    void bindChannels();
 };
 
 #endif // TAKING_THE_TEMPERATURE_VMESYSTEM_H
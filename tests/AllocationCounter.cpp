@@ -0,0 +1,45 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "AllocationCounter.h"
+
+namespace
+{
+//! All the threads, so that the bus thread of the pipeline is counted too.
+std::atomic<uint64_t> allocationCount(0);
+} // namespace
+
+uint64_t processAllocationCount()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+// The array, nothrow and sized variants of the standard library forward to
+// these four.
+void* operator new(std::size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    // aligned_alloc wants a size multiple of the alignment, never 0.
+    const auto align = static_cast<std::size_t>(alignment);
+    const std::size_t alignedSize =
+        size == 0 ? align : (size + align - 1) / align * align;
+    if (void* memory = std::aligned_alloc(align, alignedSize))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+    std::free(memory);
+}
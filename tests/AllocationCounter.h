@@ -0,0 +1,13 @@
+#ifndef TAKING_THE_TEMPERATURE_ALLOCATIONCOUNTER_H
+#define TAKING_THE_TEMPERATURE_ALLOCATIONCOUNTER_H
+
+#include <cstdint>
+
+/**
+ * @brief Number of heap allocations made so far by all the threads.
+ * The test executable replaces the global operator new, aligned or not, to
+ * count them.
+ */
+uint64_t processAllocationCount();
+
+#endif // TAKING_THE_TEMPERATURE_ALLOCATIONCOUNTER_H
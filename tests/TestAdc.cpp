@@ -0,0 +1,23 @@
+#include <utility>
+
+#include "TestAdc.h"
+
+TestAdc::TestAdc(ReadFunction readFunction, uint16_t maxAdcs)
+    : readFunction(std::move(readFunction))
+{
+    tmodSetReadAdcBackend(&TestAdc::read, this, maxAdcs);
+}
+
+TestAdc::~TestAdc()
+{
+    if (tmodGetReadAdcBackendContext() == this)
+        tmodSetReadAdcBackend(nullptr, nullptr);
+}
+
+int16_t TestAdc::read(uint16_t hardwareAddress, void* context)
+{
+    auto* adc = static_cast<TestAdc*>(context);
+    const int16_t value = adc->readFunction(hardwareAddress, adc->reads.size());
+    adc->reads.push_back(hardwareAddress);
+    return value;
+}
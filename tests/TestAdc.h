@@ -0,0 +1,48 @@
+#ifndef TAKING_THE_TEMPERATURE_TESTADC_H
+#define TAKING_THE_TEMPERATURE_TESTADC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "tmod.h"
+
+/**
+ * @brief Adc backend of the tests, installed into tmod for its lifetime.
+ * Reads are logged, and served by a function of the tests.
+ */
+class TestAdc
+{
+public:
+    /**
+     * Value of a read.
+     * @param hardwareAddress: address of the Adc.
+     * @param read: number of reads made before this one.
+     */
+    using ReadFunction =
+        std::function<int16_t(uint16_t hardwareAddress, size_t read)>;
+
+    /**
+     * @brief Install the backend.
+     * @param maxAdcs: number of Adcs served.
+     */
+    explicit TestAdc(ReadFunction readFunction,
+                     uint16_t maxAdcs = TMOD_MAX_ADCS);
+
+    //! Restore the dummy tmod implementation, if still installed.
+    ~TestAdc();
+
+    TestAdc(const TestAdc&) = delete;
+    TestAdc& operator=(const TestAdc&) = delete;
+
+    //! Addresses read so far, in order.
+    std::vector<uint16_t> reads;
+
+private:
+    ReadFunction readFunction;
+
+    static int16_t read(uint16_t hardwareAddress, void* context);
+};
+
+#endif // TAKING_THE_TEMPERATURE_TESTADC_H
@@ -0,0 +1,125 @@
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "TemperatureSensor.h"
+#include "TestAdc.h"
+#include "VmeSystem.h"
+
+namespace
+{
+//! Every read returns adcValue.
+struct ControlledAdcFixture
+{
+    int16_t adcValue = 100;
+    TestAdc adc{[this](uint16_t, size_t) { return adcValue; }};
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_AdaptiveSampling_BackOffAndSnapBack, ControlledAdcFixture)
+{
+    TemperatureSensor sensor(2, SensorType::VOLTAGE_0V_10V, 0.1f, 0.f);
+    AdaptiveSamplingConfig config;
+    config.enabled = true;
+    config.band = 0.5f;
+    config.steadyReads = 2;
+    config.maxStaleness = 4;
+    sensor.setAdaptiveSampling(config);
+
+    // Steady readings: the interval doubles every 2 reads, up to 4 cycles.
+    vector<uint16_t> intervals;
+    for (int cycle = 0; cycle < 20; cycle++)
+    {
+        adcValue = (int16_t)(100 + cycle % 2 * 3);
+        sensor.measureTemperature();
+        intervals.push_back(sensor.getReadInterval());
+    }
+    BOOST_TEST(sensor.getReadInterval() == 4);
+    BOOST_TEST(sensor.getReadsPerformed() + sensor.getReadsSaved() == 20);
+    BOOST_TEST(sensor.getReadsPerformed() == adc.reads.size());
+    BOOST_TEST(sensor.getReadsSaved() > 10);
+
+    // Never more than maxStaleness cycles without a read.
+    const uint64_t readsBefore = sensor.getReadsPerformed();
+    for (int cycle = 0; cycle < 4; cycle++)
+        sensor.measureTemperature();
+    BOOST_TEST(sensor.getReadsPerformed() == readsBefore + 1);
+
+    // A change is served at most maxStaleness cycles late, then full rate.
+    adcValue = 200;
+    int latency = 1;
+    while (sensor.measureTemperature() != 20.f)
+        latency++;
+    BOOST_TEST(latency <= 4);
+    BOOST_TEST(sensor.getReadInterval() == 1);
+    const size_t reads = adc.reads.size();
+    sensor.measureTemperature();
+    BOOST_TEST(adc.reads.size() == reads + 1);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_AdaptiveSampling_Disabled, ControlledAdcFixture)
+{
+    TemperatureSensor sensor(2, SensorType::VOLTAGE_0V_10V, 0.1f, 0.f);
+    for (int cycle = 0; cycle < 10; cycle++)
+        sensor.measureTemperature();
+    BOOST_TEST(adc.reads.size() == 10);
+    BOOST_TEST(sensor.getReadsSaved() == 0);
+
+    AdaptiveSamplingConfig config;
+    config.maxStaleness = 0;
+    BOOST_CHECK_THROW(sensor.setAdaptiveSampling(config), invalid_argument);
+    config.maxStaleness = 8;
+    config.band = -1.f;
+    BOOST_CHECK_THROW(sensor.setAdaptiveSampling(config), invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_AdaptiveSampling_Report, ControlledAdcFixture)
+{
+    VmeSystem vmeSystem;
+    std::stringstream output;
+    vmeSystem.setOutputStream(&output);
+    vmeSystem.addSensor(1, SensorType::VOLTAGE_0V_10V);
+    vmeSystem.addSensor(3, SensorType::VOLTAGE_0V_10V);
+    AdaptiveSamplingConfig config;
+    config.enabled = true;
+    config.steadyReads = 1;
+    BOOST_CHECK_THROW(vmeSystem.setAdaptiveSampling(5, config),
+                      invalid_argument);
+    vmeSystem.setAdaptiveSampling(3, config);
+
+    for (int cycle = 0; cycle < 10; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    const auto& sensors = vmeSystem.getTemperatureSensors();
+    BOOST_TEST(sensors.at(1).getReadsPerformed() == 10);
+    BOOST_TEST(sensors.at(3).getReadsSaved() > 0);
+
+    // Only the adaptive sensor reports its saved reads.
+    const string report = output.str();
+    size_t count = 0;
+    for (size_t i = report.find("Reads saved"); i != string::npos;
+         i = report.find("Reads saved", i + 1))
+        count++;
+    BOOST_TEST(count == 10);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_AdaptiveSampling_LongestInterval)
+{
+    TemperatureSensor sensor(2, SensorType::VOLTAGE_0V_10V, 0.1f, 0.f);
+    AdaptiveSamplingConfig config;
+    config.enabled = true;
+    config.steadyReads = 1;
+    config.maxStaleness = UINT16_MAX;
+    sensor.setAdaptiveSampling(config);
+
+    // Doubling 32768 does not wrap around.
+    for (int read = 0; read < 20; read++)
+        sensor.applyAdcValue(100);
+    BOOST_TEST(sensor.getReadInterval() == UINT16_MAX);
+}
@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <ostream>
+#include <streambuf>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "AllocationCounter.h"
+#include "ReportWriter.h"
+#include "ShmPublisher.h"
+#include "VmeSystem.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+//! Stream buffer discarding everything, without allocating.
+class NullBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override
+    {
+        return n;
+    }
+};
+
+void addSensors(VmeSystem& vmeSystem)
+{
+    vmeSystem.addSensor(0, SensorType::VOLTAGE_0V_10V, 0.1f, -20.f, "Inlet");
+    vmeSystem.addSensor(3, SensorType::CURRENT_4MA_20MA, 0.2f, 0.f, "a: b");
+    vmeSystem.addSensor(7, SensorType::VOLTAGE_0V_10V, 1.f, 0.f, "");
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_VmeSystem_SteadyStateDoesNotAllocate)
+{
+    NullBuffer nullBuffer;
+    std::ostream sink(&nullBuffer);
+    ShmPublisher publisher("/ttt_test_allocation_free");
+    VmeSystem vmeSystem;
+    vmeSystem.setOutputStream(&sink);
+    vmeSystem.addPublisher(&publisher);
+    addSensors(vmeSystem);
+    AdaptiveSamplingConfig adaptive;
+    adaptive.enabled = true;
+    vmeSystem.setAdaptiveSampling(7, adaptive);
+    vmeSystem.setSummaryStream(&sink);
+    vmeSystem.addChannelGroup({"crate", {}, AGGREGATE_ALL});
+    vmeSystem.addChannelGroup({"inlet", {0, 3}, AGGREGATE_MIN});
+
+    vmeSystem.measureTemperaturesAndProduceReport();
+    uint64_t warmedUp = processAllocationCount();
+    for (int cycle = 0; cycle < 1000; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(processAllocationCount() - warmedUp == 0);
+
+    vmeSystem.startPipeline(3);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    warmedUp = processAllocationCount();
+    for (int cycle = 0; cycle < 1000; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(processAllocationCount() - warmedUp == 0);
+    vmeSystem.stopPipeline();
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportWriter_SteadyStateDoesNotAllocate)
+{
+    const fs::path directory = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(directory);
+    {
+        ReportWriterConfig config;
+        config.cyclesPerBatch = 5;
+        ReportWriter writer((directory / "report.yaml").string(), config);
+        VmeSystem vmeSystem;
+        vmeSystem.setOutputStream(&writer.getStream());
+        // Reports of a constant size: the batch buffers only grow when the
+        // reports do.
+        addSensors(vmeSystem);
+
+        for (int cycle = 0; cycle < 10; cycle++)
+            vmeSystem.measureTemperaturesAndProduceReport();
+        const uint64_t warmedUp = processAllocationCount();
+        for (int cycle = 0; cycle < 1000; cycle++)
+            vmeSystem.measureTemperaturesAndProduceReport();
+        BOOST_TEST(processAllocationCount() - warmedUp == 0);
+    }
+    fs::remove_all(directory);
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include "ChannelAggregator.h"
+#include "Clock.h"
+#include "TestAdc.h"
+#include "VmeSystem.h"
+
+namespace
+{
+//! Each read returns the value of its address.
+struct AddressAdcFixture
+{
+    int16_t values[TMOD_MAX_ADCS] = {};
+    TestAdc adc{[this](uint16_t hardwareAddress, size_t) {
+        return values[hardwareAddress];
+    }};
+    VirtualClock clock;
+    std::stringstream output;
+    std::stringstream summaries;
+    VmeSystem vmeSystem;
+
+    AddressAdcFixture()
+    {
+        vmeSystem.setClock(&clock);
+        vmeSystem.setOutputStream(&output);
+        vmeSystem.setSummaryStream(&summaries);
+        for (uint16_t hardwareId : {1, 2, 3, 5})
+        {
+            vmeSystem.addSensor(hardwareId, SensorType::VOLTAGE_0V_10V, 0.5f,
+                                0.f);
+            values[hardwareId] = (int16_t)(10 * hardwareId);
+        }
+    }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ChannelAggregator_MatchesScalarReduction)
+{
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> temperatures(-40.f, 120.f);
+    // Below, at and across multiples of the lane count.
+    for (uint16_t channels = 1; channels <= 40; channels++)
+    {
+        vector<uint16_t> hardwareIds;
+        for (uint16_t channel = 0; channel < channels; channel++)
+            hardwareIds.push_back((uint16_t)(2 * channel));
+        ChannelAggregator aggregator;
+        aggregator.bind(hardwareIds);
+        aggregator.addGroup({"all", {}, AGGREGATE_ALL});
+        aggregator.addGroup({"odd", {}, AGGREGATE_ALL});
+        aggregator.removeGroup("odd");
+        vector<uint16_t> odd;
+        for (uint16_t channel = 1; channel < channels; channel += 2)
+            odd.push_back(hardwareIds[channel]);
+        if (!odd.empty())
+            aggregator.addGroup({"odd", odd, AGGREGATE_ALL});
+
+        vector<float> values(channels);
+        vector<bool> faults(channels);
+        for (uint16_t channel = 0; channel < channels; channel++)
+        {
+            // Rounded, so that ties happen.
+            values[channel] = std::round(temperatures(random));
+            faults[channel] = random() % 5 == 0;
+            aggregator.record(channel, values[channel], faults[channel]);
+        }
+        aggregator.aggregate();
+
+        float min = INFINITY;
+        float max = -INFINITY;
+        double sum = 0.;
+        uint16_t coldest = UINT16_MAX;
+        uint16_t hottest = UINT16_MAX;
+        uint16_t faulted = 0;
+        for (uint16_t channel = 0; channel < channels; channel++)
+        {
+            if (faults[channel])
+            {
+                faulted++;
+                continue;
+            }
+            if (values[channel] < min)
+                coldest = hardwareIds[channel];
+            if (values[channel] > max)
+                hottest = hardwareIds[channel];
+            min = std::min(min, values[channel]);
+            max = std::max(max, values[channel]);
+            sum += values[channel];
+        }
+        const GroupAggregate& all = aggregator.getAggregates()[0];
+        BOOST_TEST(all.channels == channels);
+        BOOST_TEST(all.faults == faulted);
+        if (faulted == channels)
+        {
+            BOOST_TEST(std::isnan(all.mean));
+            BOOST_TEST(all.hottest == UINT16_MAX);
+            continue;
+        }
+        BOOST_TEST(all.min == min);
+        BOOST_TEST(all.max == max);
+        BOOST_TEST(all.coldest == coldest);
+        BOOST_TEST(all.hottest == hottest);
+        BOOST_TEST(all.spread == max - min);
+        BOOST_TEST(all.mean == sum / (channels - faulted),
+                   boost::test_tools::tolerance(1e-4));
+        if (!odd.empty())
+            BOOST_TEST(aggregator.getAggregates()[1].channels == odd.size());
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_VmeSystem_GroupSummaries, AddressAdcFixture)
+{
+    vmeSystem.addChannelGroup({"crate", {}, AGGREGATE_ALL});
+    vmeSystem.addChannelGroup(
+        {"left", {2, 1}, AGGREGATE_MAX | AGGREGATE_MEAN});
+    BOOST_CHECK_THROW(vmeSystem.addChannelGroup({"left", {1}}),
+                      invalid_argument);
+    BOOST_CHECK_THROW(vmeSystem.addChannelGroup({"right", {4}}),
+                      invalid_argument);
+    BOOST_CHECK_THROW(vmeSystem.addChannelGroup({"a b", {}}),
+                      invalid_argument);
+    BOOST_CHECK_THROW(vmeSystem.addChannelGroup({"none", {}, 0}),
+                      invalid_argument);
+
+    vmeSystem.measureTemperaturesAndProduceReport();
+    // The virtual clock stands still, all the cycles share a timestamp.
+    const string time = output.str().substr(0, output.str().find(":\n"));
+    BOOST_TEST(summaries.str() ==
+               "- {Time: " + time +
+                   ", Group: crate, Channels: 4, Faults: 0, Min: 5, "
+                   "Coldest: 1, Max: 25, Hottest: 5, Mean: 13.75, "
+                   "Spread: 20}\n"
+                   "- {Time: " +
+                   time +
+                   ", Group: left, Channels: 2, Max: 10, Hottest: 2, "
+                   "Mean: 7.5}\n");
+
+    // Without fault tolerance, a faulted sensor aborts the cycle.
+    values[5] = INT16_MAX;
+    BOOST_CHECK_THROW(vmeSystem.measureTemperaturesAndProduceReport(),
+                      runtime_error);
+
+    vmeSystem.setFaultTolerance(true);
+    vmeSystem.removeChannelGroup("left");
+    BOOST_CHECK_THROW(vmeSystem.removeChannelGroup("left"), invalid_argument);
+    for (bool pipelined : {false, true})
+    {
+        if (pipelined)
+            vmeSystem.startPipeline();
+        summaries.str("");
+        output.str("");
+        vmeSystem.measureTemperaturesAndProduceReport();
+        BOOST_TEST(summaries.str() ==
+                   "- {Time: " + time +
+                       ", Group: crate, Channels: 4, Faults: 1, Min: 5, "
+                       "Coldest: 1, Max: 15, Hottest: 3, Mean: 10, "
+                       "Spread: 10}\n");
+        BOOST_TEST(output.str().find("    Status: Fault\n    Temperature: "
+                                     ".nan\n") != string::npos);
+        const auto& readings = vmeSystem.getLastSweep().readings;
+        BOOST_TEST(std::isnan(readings[3].temperature));
+        BOOST_TEST(vmeSystem.getLastAggregates()[0].faults == 1);
+    }
+    vmeSystem.stopPipeline();
+
+    // A removed sensor leaves its groups.
+    vmeSystem.removeSensor(1);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(vmeSystem.getLastAggregates()[0].channels == 3);
+    BOOST_TEST(vmeSystem.getLastAggregates()[0].coldest == 2);
+}
@@ -0,0 +1,71 @@
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <boost/test/unit_test.hpp>
+
+#include "TestAdc.h"
+#include "VmeSystem.h"
+
+namespace
+{
+//! Large crate, each read returns its address as raw value.
+struct LargeCrateFixture
+{
+    static constexpr uint16_t CHANNELS = 4096;
+
+    TestAdc adc{[](uint16_t hardwareAddress, size_t) {
+                    return (int16_t)(hardwareAddress % TMOD_MAX_ADC_VALUE);
+                },
+                CHANNELS};
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_CrateCapacity_Capacity, LargeCrateFixture)
+{
+    std::stringstream output;
+    VmeSystem vmeSystem;
+    vmeSystem.setOutputStream(&output);
+    vmeSystem.addSensor(3000, SensorType::VOLTAGE_0V_10V);
+    vmeSystem.addSensor(CHANNELS - 1, SensorType::VOLTAGE_0V_10V);
+    BOOST_CHECK_THROW(
+        vmeSystem.addSensor(CHANNELS, SensorType::VOLTAGE_0V_10V),
+        invalid_argument);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(vmeSystem.getLastSweep().readings[0].adcValue ==
+               3000 % TMOD_MAX_ADC_VALUE);
+
+    // The dummy backend is back to its own channels.
+    tmodSetReadAdcBackend(nullptr, nullptr);
+    BOOST_TEST(tmodMaxAdcs() == TMOD_MAX_ADCS);
+    BOOST_TEST(tmodReadAdc(TMOD_MAX_ADCS) == TMOD_INVALID_VOLTAGE_MEASUREMENT);
+    VmeSystem dummySystem;
+    BOOST_CHECK_THROW(
+        dummySystem.addSensor(TMOD_MAX_ADCS, SensorType::VOLTAGE_0V_10V),
+        invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_CrateCapacity_SparseSensors, LargeCrateFixture)
+{
+    // Only the two sensors are read, whatever their addresses.
+    std::stringstream output;
+    VmeSystem vmeSystem;
+    vmeSystem.setOutputStream(&output);
+    for (uint16_t hardwareId : {0, 7, CHANNELS - 1})
+        vmeSystem.addSensor(hardwareId, SensorType::VOLTAGE_0V_10V);
+    vmeSystem.removeSensor(7);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    vmeSystem.startPipeline();
+    vmeSystem.measureTemperaturesAndProduceReport();
+    vmeSystem.stopPipeline();
+
+    const auto& readings = vmeSystem.getLastSweep().readings;
+    BOOST_REQUIRE(readings.size() == 2);
+    BOOST_TEST(readings[1].hardwareId == CHANNELS - 1);
+    BOOST_TEST(readings[1].adcValue == (CHANNELS - 1) % TMOD_MAX_ADC_VALUE);
+    for (uint16_t hardwareAddress : adc.reads)
+        BOOST_TEST((hardwareAddress == 0 || hardwareAddress == CHANNELS - 1));
+}
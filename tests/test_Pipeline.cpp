@@ -0,0 +1,124 @@
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp>
+
+#include "TestAdc.h"
+#include "VmeSystem.h"
+
+namespace
+{
+//! Each read returns the number of reads before it.
+struct SequenceAdcFixture
+{
+    //! Read returning a value too high for a sensor, none by default.
+    size_t tooHighRead = SIZE_MAX;
+    TestAdc adc{[this](uint16_t, size_t read) {
+        return read == tooHighRead ? INT16_MAX : (int16_t)read;
+    }};
+    std::stringstream output;
+    //! Destroyed first, which stops the pipeline.
+    VmeSystem vmeSystem;
+
+    SequenceAdcFixture()
+    {
+        vmeSystem.setOutputStream(&output);
+        vmeSystem.addSensor(1, SensorType::VOLTAGE_0V_10V, 1.f, 0.f);
+        vmeSystem.addSensor(3, SensorType::VOLTAGE_0V_10V, 1.f, 0.f);
+    }
+};
+} // namespace
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Pipeline_CyclesInOrder, SequenceAdcFixture)
+{
+    for (size_t cycleBuffers : {2, 3, 5})
+    {
+        const auto firstRead = (int16_t)adc.reads.size();
+        vmeSystem.startPipeline(cycleBuffers);
+        BOOST_TEST(vmeSystem.isPipelineRunning());
+        for (int16_t cycle = 0; cycle < 50; cycle++)
+        {
+            vmeSystem.measureTemperaturesAndProduceReport();
+            // The sensors of a cycle are read in order, cycle after cycle.
+            const SweepSnapshot& sweep = vmeSystem.getLastSweep();
+            BOOST_REQUIRE(sweep.readings.size() == 2);
+            BOOST_TEST(sweep.readings[0].hardwareId == 1);
+            BOOST_TEST(sweep.readings[0].adcValue == firstRead + 2 * cycle);
+            BOOST_TEST(sweep.readings[1].adcValue ==
+                       firstRead + 2 * cycle + 1);
+            BOOST_TEST(sweep.readings[1].temperature ==
+                       (float)(firstRead + 2 * cycle + 1));
+        }
+        vmeSystem.stopPipeline();
+        BOOST_TEST(!vmeSystem.isPipelineRunning());
+        // The cycles acquired ahead are dropped.
+        BOOST_TEST(adc.reads.size() <= firstRead + 2 * (50 + cycleBuffers - 1));
+        adc.reads.clear();
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Pipeline_Restrictions, SequenceAdcFixture)
+{
+    BOOST_CHECK_THROW(vmeSystem.startPipeline(1), invalid_argument);
+    vmeSystem.startPipeline();
+    BOOST_CHECK_THROW(vmeSystem.startPipeline(), runtime_error);
+    BOOST_CHECK_THROW(vmeSystem.addSensor(5, SensorType::VOLTAGE_0V_10V),
+                      runtime_error);
+    BOOST_CHECK_THROW(vmeSystem.removeSensor(1), runtime_error);
+    // Calibration is applied by the processing thread and stays allowed.
+    vmeSystem.setScalingData(1, 2.f, 0.f);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(vmeSystem.getLastSweep().readings[0].temperature == 0.f);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(vmeSystem.getLastSweep().readings[0].temperature == 4.f);
+
+    vmeSystem.stopPipeline();
+    vmeSystem.addSensor(5, SensorType::VOLTAGE_0V_10V);
+    BOOST_TEST(vmeSystem.getTemperatureSensors().size() == 3);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Pipeline_ErrorsReportedWithTheirCycle, SequenceAdcFixture)
+{
+    // Second sensor of the third cycle.
+    tooHighRead = 5;
+    vmeSystem.startPipeline();
+    vmeSystem.measureTemperaturesAndProduceReport();
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_CHECK_THROW(vmeSystem.measureTemperaturesAndProduceReport(),
+                      runtime_error);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    // As without pipeline, the failed cycle keeps its number.
+    BOOST_TEST(vmeSystem.getLastSweep().cycle == 4);
+    BOOST_TEST(vmeSystem.getLastSweep().readings[1].adcValue == 7);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Pipeline_DroppedCyclesNotSampled, SequenceAdcFixture)
+{
+    AdaptiveSamplingConfig config;
+    config.enabled = true;
+    config.band = 1e6f;
+    config.steadyReads = 1;
+    vmeSystem.setAdaptiveSampling(3, config);
+
+    // Cycles scheduled ahead and dropped at the stop are not counted.
+    vmeSystem.startPipeline(5);
+    for (int cycle = 0; cycle < 7; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    vmeSystem.stopPipeline();
+    for (int cycle = 0; cycle < 3; cycle++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+
+    const auto& sensors = vmeSystem.getTemperatureSensors();
+    BOOST_TEST(sensors.at(1).getReadsPerformed() == 10);
+    BOOST_TEST(sensors.at(1).getReadsSaved() == 0);
+    BOOST_TEST(sensors.at(3).getReadsPerformed() +
+                   sensors.at(3).getReadsSaved() ==
+               10);
+    BOOST_TEST(sensors.at(3).getCyclesSinceRead() <
+               sensors.at(3).getReadInterval());
+}
@@ -0,0 +1,237 @@
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "ReplayBackend.h"
+#include "TestAdc.h"
+#include "VmeSystem.h"
+
+namespace utf = boost::unit_test;
+namespace fs = boost::filesystem;
+
+namespace
+{
+const char REPORT[] = "2021-Feb-09 20:55:51:\n"
+                      "  2-PT1000:\n"
+                      "    Hardware Id: 2\n"
+                      "    Name: PT1000\n"
+                      "    Sensor type: Current 4-20mA\n"
+                      "    Scaling factor: 3\n"
+                      "    Offset: -2\n"
+                      "    Current time: 2021-Feb-09 20:55:51\n"
+                      "    Temperature: 15619\n"
+                      "    Min temperature: 15619\n"
+                      "    Max temperature: 15619\n"
+                      "  3-Unnamed:\n"
+                      "    Hardware Id: 3\n"
+                      "    Name: Unnamed\n"
+                      "    Sensor type: Voltage 0-10V\n"
+                      "    Scaling factor: 1\n"
+                      "    Offset: 0\n"
+                      "    Current time: 2021-Feb-09 20:55:51\n"
+                      "    Temperature: 2152\n"
+                      "    Min temperature: 2152\n"
+                      "    Max temperature: 2152\n"
+                      "2021-Feb-09 20:55:51:\n"
+                      "  2-PT1000:\n"
+                      "    Hardware Id: 2\n"
+                      "    Name: PT1000\n"
+                      "    Sensor type: Current 4-20mA\n"
+                      "    Scaling factor: 3\n"
+                      "    Offset: -2\n"
+                      "    Current time: 2021-Feb-09 20:55:51\n"
+                      "    Temperature: 29863\n"
+                      "    Min temperature: 15619\n"
+                      "    Max temperature: 29863\n"
+                      "  3-Unnamed:\n"
+                      "    Hardware Id: 3\n"
+                      "    Name: Unnamed\n"
+                      "    Sensor type: Voltage 0-10V\n"
+                      "    Scaling factor: 1\n"
+                      "    Offset: 0\n"
+                      "    Current time: 2021-Feb-09 20:55:51\n"
+                      "    Temperature: 100\n"
+                      "    Min temperature: 100\n"
+                      "    Max temperature: 2152\n";
+
+fs::path writeReport()
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    std::ofstream(path.string()) << REPORT;
+    return path;
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Recording_FromReportYaml)
+{
+    fs::path path = writeReport();
+    Recording recording = Recording::fromReportYaml(path.string());
+    fs::remove(path);
+
+    BOOST_TEST(recording.getFrameCount() == 2);
+    BOOST_TEST(recording.getChannelCount() == 4);
+    BOOST_TEST(recording.getRecordedChannels() == vector<uint16_t>({2, 3}),
+               boost::test_tools::per_element());
+    // Adc values are recovered from the scaling data.
+    BOOST_TEST(recording.getSample(0, 2) == 5207);
+    BOOST_TEST(recording.getSample(1, 2) == 9955);
+    BOOST_TEST(recording.getSample(1, 3) == 100);
+    BOOST_TEST(recording.getSample(0, 0) == TMOD_INVALID_VOLTAGE_MEASUREMENT);
+    // Both reports were written within the same second.
+    BOOST_TEST(recording.getTimestampMs(1) - recording.getTimestampMs(0) ==
+               500);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Recording_FaultedSensor)
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    {
+        // The second sensor reads a value too high.
+        TestAdc adc([](uint16_t hardwareAddress, size_t) {
+            return hardwareAddress == 3 ? INT16_MAX : (int16_t)100;
+        });
+        std::ofstream file(path.string());
+        VmeSystem vmeSystem;
+        vmeSystem.setOutputStream(&file);
+        vmeSystem.setFaultTolerance(true);
+        vmeSystem.addSensor(2, SensorType::VOLTAGE_0V_10V, 0.5f, 0.f);
+        vmeSystem.addSensor(3, SensorType::VOLTAGE_0V_10V, 0.5f, 0.f);
+        vmeSystem.measureTemperaturesAndProduceReport();
+    }
+
+    ReplayBackend replay(Recording::fromReportYaml(path.string()),
+                         AS_FAST_AS_POSSIBLE);
+    fs::remove(path);
+    // The faulted channel is not counted as recorded, nor replayed.
+    BOOST_TEST(replay.getRecording().getRecordedChannels() ==
+                   vector<uint16_t>({2}),
+               boost::test_tools::per_element());
+    replay.install();
+    BOOST_TEST(tmodReadAdc(2) == 100);
+    BOOST_TEST(tmodReadAdc(3) == TMOD_INVALID_VOLTAGE_MEASUREMENT);
+    replay.uninstall();
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Recording_CaptureRoundTrip)
+{
+    Recording recording;
+    recording.setChannelCount(3);
+    recording.addFrame(1000, {1, TMOD_INVALID_VOLTAGE_MEASUREMENT, 3});
+    recording.addFrame(2000, {4, 5, 6});
+    BOOST_CHECK_THROW(recording.addFrame(3000, {1}), invalid_argument);
+
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    recording.saveCapture(path.string());
+    Recording loaded = Recording::fromCapture(path.string());
+    fs::remove(path);
+
+    BOOST_TEST(loaded.getFrameCount() == 2);
+    BOOST_TEST(loaded.getChannelCount() == 3);
+    BOOST_TEST(loaded.getTimestampMs(1) == 2000);
+    BOOST_TEST(loaded.getSample(0, 1) == TMOD_INVALID_VOLTAGE_MEASUREMENT);
+    BOOST_TEST(loaded.getSample(1, 1) == 5);
+    BOOST_TEST(loaded.getRecordedChannels().size() == 3);
+
+    BOOST_CHECK_THROW(Recording::fromCapture(path.string()), runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReplayBackend_AsFastAsPossible, *utf::tolerance(0.00001))
+{
+    fs::path path = writeReport();
+    ReplayBackend replay(Recording::fromReportYaml(path.string()),
+                         AS_FAST_AS_POSSIBLE);
+    fs::remove(path);
+    replay.install();
+
+    VmeSystem vmeSystem;
+    std::stringstream output;
+    vmeSystem.setOutputStream(&output);
+    vmeSystem.addSensor(2, SensorType::CURRENT_4MA_20MA, 3.f, -2.f);
+    vmeSystem.addSensor(3, SensorType::VOLTAGE_0V_10V);
+
+    const map<uint16_t, TemperatureSensor>& sensors =
+        vmeSystem.getTemperatureSensors();
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(sensors.at(2).getTemperature() == 15619.f);
+    BOOST_TEST(sensors.at(3).getTemperature() == 2152.f);
+
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(sensors.at(2).getTemperature() == 29863.f);
+    BOOST_TEST(sensors.at(3).getTemperature() == 100.f);
+
+    // The recording loops.
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(sensors.at(3).getTemperature() == 2152.f);
+    BOOST_TEST(sensors.at(3).getMinTemperature() == 100.f);
+
+    replay.uninstall();
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReplayBackend_FanOut)
+{
+    Recording recording;
+    recording.setChannelCount(2);
+    recording.addFrame(0, {10, 20});
+    recording.addFrame(1000, {11, 21});
+    recording.addFrame(2000, {12, 22});
+
+    ReplayBackend replay(recording, AS_FAST_AS_POSSIBLE);
+    replay.setFanOut(6);
+    replay.setLooping(false);
+    replay.install();
+
+    // Replicas of a recorded channel are shifted by one frame each.
+    BOOST_TEST(tmodReadAdc(0) == 10);
+    BOOST_TEST(tmodReadAdc(1) == 20);
+    BOOST_TEST(tmodReadAdc(2) == 11);
+    BOOST_TEST(tmodReadAdc(3) == 21);
+    BOOST_TEST(tmodReadAdc(4) == 12);
+    BOOST_TEST(tmodReadAdc(5) == 22);
+    BOOST_TEST(tmodReadAdc(6) == TMOD_INVALID_VOLTAGE_MEASUREMENT);
+
+    // Next sweep, the last frame is held as looping is disabled.
+    BOOST_TEST(tmodReadAdc(0) == 11);
+    BOOST_TEST(tmodReadAdc(4) == 12);
+    BOOST_TEST(replay.getCurrentFrame() == 1);
+
+    replay.uninstall();
+    BOOST_TEST(tmodReadAdc(0) <= TMOD_MAX_ADC_VALUE);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReplayBackend_UninstallOnlyItself)
+{
+    Recording recording;
+    recording.setChannelCount(1);
+    recording.addFrame(0, {10});
+    ReplayBackend second(recording, AS_FAST_AS_POSSIBLE);
+    {
+        ReplayBackend first(recording, AS_FAST_AS_POSSIBLE);
+        first.install();
+        second.install();
+        // Destroying first leaves second installed.
+    }
+    BOOST_TEST(tmodGetReadAdcBackendContext() == &second);
+    BOOST_TEST(tmodReadAdc(0) == 10);
+    second.uninstall();
+    BOOST_TEST(tmodGetReadAdcBackendContext() == nullptr);
+
+    // The channel count of the highest hardware Id would not fit.
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    std::ofstream(path.string()) << "2021-Feb-09 20:55:51:\n"
+                                    "  65535-Unnamed:\n"
+                                    "    Hardware Id: 65535\n"
+                                    "    Scaling factor: 1\n"
+                                    "    Offset: 0\n"
+                                    "    Temperature: 10\n";
+    BOOST_CHECK_THROW(Recording::fromReportYaml(path.string()), runtime_error);
+    fs::remove(path);
+}
@@ -0,0 +1,283 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "Clock.h"
+#include "ReportMerger.h"
+#include "ReportReader.h"
+#include "ReportWriter.h"
+#include "StreamProtocol.h"
+#include "VmeSystem.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+//! Crates sharing a virtual clock, each with its own report.
+struct CratesFixture
+{
+    VirtualClock clock;
+    fs::path directory = fs::temp_directory_path() / fs::unique_path();
+
+    CratesFixture() { fs::create_directories(directory); }
+
+    ~CratesFixture() { fs::remove_all(directory); }
+
+    string path(const string& name) const
+    {
+        return (directory / name).string();
+    }
+
+    /**
+     * Write cycles every minute, the second crate two seconds after the
+     * first one.
+     */
+    void writeCrates(ostream& first, ostream& second, int cycles)
+    {
+        VmeSystem crates[2];
+        crates[0].setOutputStream(&first);
+        crates[1].setOutputStream(&second);
+        for (auto& crate : crates)
+        {
+            crate.setClock(&clock);
+            crate.addSensor(1, SensorType::VOLTAGE_0V_10V);
+            crate.addSensor(2, SensorType::CURRENT_4MA_20MA);
+        }
+        for (int cycle = 0; cycle < cycles; cycle++)
+        {
+            crates[0].measureTemperaturesAndProduceReport();
+            clock.advance(std::chrono::seconds(2));
+            crates[1].measureTemperaturesAndProduceReport();
+            clock.advance(std::chrono::seconds(58));
+        }
+    }
+
+    static string merge(vector<unique_ptr<ReportSource>> sources,
+                        std::chrono::milliseconds tolerance)
+    {
+        std::stringstream output;
+        ReportMerger merger(std::move(sources), output, tolerance);
+        BOOST_TEST(merger.run() == MERGE_END_OF_STREAM);
+        return output.str();
+    }
+
+    static size_t count(const string& text, const string& pattern)
+    {
+        size_t count = 0;
+        for (size_t i = text.find(pattern); i != string::npos;
+             i = text.find(pattern, i + 1))
+            count++;
+        return count;
+    }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_LoserTree_MergesInOrder)
+{
+    std::mt19937 random(7);
+    for (size_t leaves = 1; leaves <= 9; leaves++)
+    {
+        // Sorted streams with duplicated keys, within and across streams.
+        vector<vector<int64_t>> streams(leaves);
+        vector<pair<int64_t, size_t>> expected;
+        for (size_t leaf = 0; leaf < leaves; leaf++)
+        {
+            int64_t key = 0;
+            for (size_t i = random() % 20; i > 0; i--)
+            {
+                key += (int64_t)(random() % 3);
+                streams[leaf].push_back(key);
+                expected.emplace_back(key, leaf);
+            }
+        }
+        std::stable_sort(expected.begin(), expected.end());
+
+        vector<size_t> positions(leaves, 0);
+        vector<int64_t> keys;
+        for (const auto& stream : streams)
+            keys.push_back(stream.empty() ? INT64_MAX : stream[0]);
+        LoserTree tree(keys);
+        vector<pair<int64_t, size_t>> merged;
+        while (tree.getWinnerKey() != INT64_MAX)
+        {
+            const size_t leaf = tree.getWinner();
+            merged.emplace_back(tree.getWinnerKey(), leaf);
+            const size_t next = ++positions[leaf];
+            tree.replaceWinnerKey(next < streams[leaf].size()
+                                      ? streams[leaf][next]
+                                      : INT64_MAX);
+        }
+        BOOST_TEST((merged == expected));
+    }
+    BOOST_CHECK_THROW(LoserTree(vector<int64_t>()), invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportMerger_BatchWithTolerance, CratesFixture)
+{
+    {
+        std::ofstream first(path("first.yaml"));
+        std::ofstream second(path("second.yaml"));
+        writeCrates(first, second, 3);
+    }
+    const auto sources = [&]() {
+        vector<unique_ptr<ReportSource>> sources;
+        sources.push_back(
+            make_unique<YamlReportSource>(path("first.yaml"), "crate1"));
+        sources.push_back(
+            make_unique<YamlReportSource>(path("second.yaml"), "crate2"));
+        return sources;
+    };
+
+    // Cycles two seconds apart are combined if the tolerance allows it.
+    const string separate = merge(sources(), std::chrono::seconds(1));
+    BOOST_TEST(count(separate, "\n  crate") == 12);
+    BOOST_TEST(count(separate, ":\n  crate") == 6);
+    const string combined = merge(sources(), std::chrono::seconds(2));
+    BOOST_TEST(count(combined, ":\n  crate1/") == 3);
+    BOOST_TEST(count(combined, "\n  crate2/") == 6);
+
+    // The merged report reads as any other report.
+    {
+        std::ofstream(path("merged.yaml")) << combined;
+    }
+    ReportReader reader(path("merged.yaml"), false);
+    const auto& keys = reader.getIndex().getSensorKeys();
+    BOOST_TEST(keys.size() == 4);
+    BOOST_TEST(std::count_if(keys.begin(), keys.end(), [](const string& key) {
+                   return key.compare(0, 7, "crate2/") == 0;
+               }) == 2);
+    const auto samples = reader.query(0, INT64_MAX);
+    BOOST_REQUIRE(samples.size() == 12);
+    // Combined entries take the time stamp of the first cycle.
+    BOOST_TEST(samples[0].timestampMs == samples[3].timestampMs);
+    BOOST_TEST(samples[4].timestampMs - samples[0].timestampMs == 60000);
+
+    BOOST_CHECK_THROW(merge(sources(), std::chrono::milliseconds(-1)),
+                      invalid_argument);
+    BOOST_CHECK_THROW(YamlReportSource(path("first.yaml"), "a/b"),
+                      invalid_argument);
+    BOOST_CHECK_THROW(YamlReportSource(path("none.yaml"), "a"),
+                      invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportMerger_CompressedAndSweeps, CratesFixture)
+{
+    std::stringstream first;
+    std::stringstream second;
+    writeCrates(first, second, 5);
+    {
+        std::ofstream(path("first.yaml")) << first.str();
+    }
+    // One compressed member or frame per line.
+    for (const auto& [extension, compression] :
+         {std::make_pair(string(".gz"), COMPRESSION_GZIP),
+          std::make_pair(string(".zst"), COMPRESSION_ZSTD)})
+    {
+        ReportWriterConfig config;
+        config.cyclesPerBatch = 1;
+        config.compression = compression;
+        ReportWriter writer(path("second.yaml" + extension), config, clock);
+        std::string line;
+        std::stringstream input(second.str());
+        while (std::getline(input, line))
+            writer.getStream() << line << "\n" << std::flush;
+    }
+
+    // Sweeps of the first crate, as captured from its stream server.
+    VmeSystem crate;
+    std::stringstream report;
+    crate.setOutputStream(&report);
+    crate.setClock(&clock);
+    crate.addSensor(7, SensorType::VOLTAGE_0V_10V);
+    string frames;
+    for (int cycle = 0; cycle < 5; cycle++)
+    {
+        crate.measureTemperaturesAndProduceReport();
+        encodeSweep(crate.getLastSweep(), {}, frames);
+        clock.advance(std::chrono::seconds(60));
+    }
+    // Truncated last frame, as when the capture was interrupted.
+    {
+        std::ofstream(path("sweeps.bin"), std::ios::binary)
+            << frames.substr(0, frames.size() - 3);
+    }
+
+    for (const string extension : {".gz", ".zst"})
+    {
+        vector<unique_ptr<ReportSource>> sources;
+        sources.push_back(
+            make_unique<YamlReportSource>(path("first.yaml"), "crate1"));
+        sources.push_back(make_unique<YamlReportSource>(
+            path("second.yaml" + extension), "crate2"));
+        sources.push_back(
+            make_unique<SweepCaptureSource>(path("sweeps.bin"), "live"));
+        const string merged = merge(std::move(sources), std::chrono::seconds(0));
+        BOOST_TEST(count(merged, "\n  crate2/") == 10);
+        BOOST_TEST(count(merged, "\n  live/7:\n    Hardware Id: 7\n") == 4);
+    }
+    BOOST_CHECK_THROW(
+        YamlReportSource(path("second.yaml.gz"), "crate2", true),
+        invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportMerger_Follow, CratesFixture)
+{
+    std::stringstream first;
+    std::stringstream second;
+    writeCrates(first, second, 4);
+    const string firstReport = first.str();
+    const string secondReport = second.str();
+    // Start of the third cycle of each crate.
+    const auto third = [](const string& report) {
+        size_t offset = 0;
+        for (int cycle = 0; cycle < 2; cycle++)
+            offset = report.find("\n2", offset + 1);
+        return offset + 1;
+    };
+
+    std::ofstream firstFile(path("first.yaml"));
+    std::ofstream secondFile(path("second.yaml"));
+    vector<unique_ptr<ReportSource>> sources;
+    sources.push_back(
+        make_unique<YamlReportSource>(path("first.yaml"), "crate1", true));
+    sources.push_back(
+        make_unique<YamlReportSource>(path("second.yaml"), "crate2", true));
+    std::stringstream output;
+    ReportMerger merger(std::move(sources), output);
+    BOOST_TEST(merger.run() == MERGE_NEED_MORE_DATA);
+
+    // Two cycles and a half of each crate. A cycle is only complete once
+    // the next one of its source starts, and it is written once the next
+    // cycle of the merge is known.
+    firstFile << firstReport.substr(0, third(firstReport) + 25) << std::flush;
+    secondFile << secondReport.substr(0, third(secondReport) + 25)
+               << std::flush;
+    BOOST_TEST(merger.run() == MERGE_NEED_MORE_DATA);
+    BOOST_TEST(merger.getCycleCount() == 2);
+    BOOST_TEST(merger.getSourceCycleCount() == 3);
+
+    firstFile << firstReport.substr(third(firstReport) + 25) << std::flush;
+    secondFile << secondReport.substr(third(secondReport) + 25) << std::flush;
+    BOOST_TEST(merger.run() == MERGE_NEED_MORE_DATA);
+    BOOST_TEST(merger.getCycleCount() == 4);
+
+    merger.getSource(0).stopFollowing();
+    merger.getSource(1).stopFollowing();
+    BOOST_TEST(merger.run() == MERGE_END_OF_STREAM);
+    BOOST_TEST(merger.getCycleCount() == 8);
+    BOOST_TEST(merger.getSourceCycleCount() == 8);
+    BOOST_TEST(count(output.str(), "\n  crate1/1-") == 4);
+}
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "ReportReader.h"
+#include "TestAdc.h"
+#include "VmeSystem.h"
+
+namespace utf = boost::unit_test;
+namespace fs = boost::filesystem;
+
+namespace
+{
+string reportCycle(const string& time, float temperature)
+{
+    string cycle = time + ":\n";
+    for (const string name : {"PT1000", "Unnamed"})
+    {
+        const string id = name == "PT1000" ? "2" : "3";
+        cycle += "  " + id + "-" + name + ":\n" + "    Hardware Id: " + id +
+                 "\n    Name: " + name +
+                 "\n    Sensor type: Voltage 0-10V\n"
+                 "    Scaling factor: 1\n    Offset: 0\n"
+                 "    Current time: " +
+                 time + "\n    Temperature: " + to_string(temperature) +
+                 "\n    Min temperature: 1\n    Max temperature: 99\n";
+    }
+    return cycle;
+}
+
+int64_t toMs(const string& time)
+{
+    using namespace boost::posix_time;
+    const ptime epoch(boost::gregorian::date(1970, 1, 1));
+    return (time_from_string(time) - epoch).total_milliseconds();
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportIndex_ParseTimestamp)
+{
+    for (const string time : {"2021-Feb-09 20:55:51", "1999-Dec-31 23:59:59",
+                              "2024-Feb-29 00:00:00.250"})
+    {
+        BOOST_TEST(ReportIndex::parseTimestamp(time.data(), time.size()) ==
+                   toMs(time));
+    }
+    const char invalid[] = "2021-Foo-09 20:55:51";
+    BOOST_TEST(ReportIndex::parseTimestamp(invalid, strlen(invalid)) == -1);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportReader_Query, *utf::tolerance(0.00001))
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    {
+        std::ofstream file(path.string());
+        file << reportCycle("2021-Feb-09 20:55:51", 10.f)
+             << reportCycle("2021-Feb-09 20:56:51", 11.f)
+             << reportCycle("2021-Feb-09 20:57:51", 12.f);
+    }
+
+    {
+        ReportReader reader(path.string());
+        BOOST_TEST(reader.getIndex().getBlocks().size() == 6);
+        BOOST_TEST(reader.getIndex().getSensorKeys().size() == 2);
+        BOOST_TEST(fs::exists(ReportReader::indexPath(path.string())));
+
+        vector<ReportSample> samples =
+            reader.query(toMs("2021-Feb-09 20:56:00"),
+                         toMs("2021-Feb-09 20:58:00"), "2-PT1000");
+        BOOST_TEST(samples.size() == 2);
+        BOOST_TEST(samples[0].temperature == 11.f);
+        BOOST_TEST(samples[1].temperature == 12.f);
+        BOOST_TEST(samples[1].hardwareId == 2);
+        BOOST_TEST(samples[1].name == "PT1000");
+        BOOST_TEST(samples[1].maxTemperature == 99.f);
+        BOOST_TEST(samples[1].timestampMs == toMs("2021-Feb-09 20:57:51"));
+
+        BOOST_TEST(reader.query(0, INT64_MAX).size() == 6);
+        BOOST_TEST(reader.query(0, INT64_MAX, "4-Unknown").empty());
+    }
+
+    // The report grows, the index is extended from its last timestamp.
+    {
+        std::ofstream file(path.string(), ios::app);
+        file << reportCycle("2021-Feb-09 20:58:51", 13.f);
+    }
+    {
+        ReportReader reader(path.string());
+        BOOST_TEST(reader.getIndex().getBlocks().size() == 8);
+        vector<ReportSample> samples = reader.query(
+            toMs("2021-Feb-09 20:57:51"), INT64_MAX, "3-Unnamed");
+        BOOST_TEST(samples.size() == 2);
+        BOOST_TEST(samples[1].temperature == 13.f);
+    }
+
+    // A rotated report is indexed again from scratch.
+    {
+        std::ofstream file(path.string(), ios::trunc);
+        file << reportCycle("2021-Feb-10 08:00:00", 14.f);
+    }
+    {
+        ReportReader reader(path.string());
+        BOOST_TEST(reader.getIndex().getBlocks().size() == 2);
+        BOOST_TEST(reader.query(0, INT64_MAX, "2-PT1000")[0].temperature ==
+                   14.f);
+    }
+
+    fs::remove(path);
+    fs::remove(ReportReader::indexPath(path.string()));
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportReader_FaultedSensor)
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    {
+        // The second sensor reads a value too high.
+        TestAdc adc([](uint16_t hardwareAddress, size_t) {
+            return hardwareAddress == 3 ? INT16_MAX : (int16_t)100;
+        });
+        std::ofstream file(path.string());
+        VmeSystem vmeSystem;
+        vmeSystem.setOutputStream(&file);
+        vmeSystem.setFaultTolerance(true);
+        vmeSystem.addSensor(2, SensorType::VOLTAGE_0V_10V, 0.5f, 0.f);
+        vmeSystem.addSensor(3, SensorType::VOLTAGE_0V_10V, 0.5f, 0.f);
+        vmeSystem.measureTemperaturesAndProduceReport();
+    }
+
+    ReportReader reader(path.string(), false);
+    const auto samples = reader.query(0, INT64_MAX);
+    BOOST_REQUIRE(samples.size() == 2);
+    BOOST_TEST(!samples[0].faulted);
+    BOOST_TEST(samples[0].temperature == 50.f);
+    BOOST_TEST(samples[1].faulted);
+    BOOST_TEST(std::isnan(samples[1].temperature));
+    BOOST_TEST(std::isnan(samples[1].minTemperature));
+    BOOST_TEST(std::isnan(samples[1].maxTemperature));
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportReader_ReadOnlyArchive)
+{
+    const fs::path directory = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(directory);
+    const fs::path path = directory / "report.yaml";
+    std::ofstream(path.string()) << reportCycle("2021-Feb-09 20:55:51", 10.f);
+    // A directory in the way of the sidecar, as root ignores the permissions.
+    fs::create_directory(ReportReader::indexPath(path.string()));
+    fs::permissions(directory, fs::owner_read | fs::owner_exe);
+
+    {
+        ReportReader reader(path.string());
+        BOOST_TEST(reader.getIndex().getBlocks().size() == 2);
+        BOOST_TEST(reader.query(0, INT64_MAX).size() == 2);
+    }
+
+    fs::permissions(directory, fs::owner_all);
+    fs::remove_all(directory);
+}
@@ -0,0 +1,175 @@
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/copy.hpp>
+#include <boost/iostreams/filter/gzip.hpp>
+#include <boost/iostreams/filter/zstd.hpp>
+#include <boost/iostreams/filtering_stream.hpp>
+#include <boost/test/unit_test.hpp>
+#include <yaml-cpp/yaml.h>
+
+#include "ReportWriter.h"
+#include "VmeSystem.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+string readFile(const fs::path& path)
+{
+    std::ifstream file(path.string(), ios::binary);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportWriter_GroupCommit)
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    {
+        ReportWriterConfig config;
+        config.cyclesPerBatch = 3;
+        config.fsyncPolicy = FSYNC_EVERY_N_CYCLES;
+        config.fsyncCycles = 6;
+        ReportWriter writer(path.string(), config);
+
+        for (int i = 0; i < 2; i++)
+            writer.getStream() << "cycle " << i << "\n" << flush;
+        BOOST_TEST(fs::file_size(path) == 0);
+
+        writer.getStream() << "cycle 2\n" << flush;
+        BOOST_TEST(readFile(path) == "cycle 0\ncycle 1\ncycle 2\n");
+        BOOST_TEST(writer.getWritevCount() == 1);
+        BOOST_TEST(writer.getFsyncCount() == 0);
+
+        for (int i = 3; i < 6; i++)
+            writer.getStream() << "cycle " << i << "\n" << flush;
+        BOOST_TEST(writer.getWritevCount() == 2);
+        BOOST_TEST(writer.getFsyncCount() == 1);
+
+        // Pending cycles are committed on close.
+        writer.getStream() << "cycle 6\n" << flush;
+    }
+    BOOST_TEST(readFile(path) == "cycle 0\ncycle 1\ncycle 2\ncycle 3\n"
+                                 "cycle 4\ncycle 5\ncycle 6\n");
+    fs::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportWriter_RotationBySize)
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    ReportWriterConfig config;
+    config.rotationSize = 16;
+    ReportWriter writer(path.string(), config);
+
+    for (int i = 0; i < 5; i++)
+        writer.getStream() << "0123456789\n" << flush;
+    writer.close();
+
+    BOOST_TEST(writer.getRotationCount() == 2);
+    BOOST_TEST(readFile(path.string() + ".1") == "0123456789\n0123456789\n");
+    BOOST_TEST(readFile(path.string() + ".2") == "0123456789\n0123456789\n");
+    BOOST_TEST(readFile(path) == "0123456789\n");
+    fs::remove(path);
+    fs::remove(path.string() + ".1");
+    fs::remove(path.string() + ".2");
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportWriter_RotationRetried)
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    ReportWriterConfig config;
+    config.rotationSize = 16;
+    ReportWriter writer(path.string(), config);
+    const string cycle = "0123456789\n";
+
+    writer.write(cycle.data(), (streamsize)cycle.size());
+    writer.endCycle();
+    // The rotation cannot rename a file removed behind the writer.
+    fs::remove(path);
+    writer.write(cycle.data(), (streamsize)cycle.size());
+    BOOST_CHECK_THROW(writer.endCycle(), runtime_error);
+    BOOST_TEST(writer.getRotationCount() == 0);
+
+    // The file is still open, and the next cycle retries the rotation.
+    std::ofstream(path.string()).close();
+    writer.write(cycle.data(), (streamsize)cycle.size());
+    writer.endCycle();
+    BOOST_TEST(writer.getRotationCount() == 1);
+    writer.write(cycle.data(), (streamsize)cycle.size());
+    writer.close();
+    BOOST_TEST(readFile(path) == cycle);
+    fs::remove(path);
+    fs::remove(path.string() + ".1");
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportWriter_WriteErrorReported)
+{
+    // Every write to /dev/full fails with ENOSPC.
+    ReportWriter writer("/dev/full");
+    VmeSystem vmeSystem;
+    vmeSystem.setOutputStream(&writer.getStream());
+    vmeSystem.addSensor(1, SensorType::VOLTAGE_0V_10V);
+    BOOST_CHECK_THROW(vmeSystem.measureTemperaturesAndProduceReport(),
+                      runtime_error);
+    BOOST_TEST(writer.getLastError().find("/dev/full") != string::npos);
+    // The stream is usable again, and the next report fails the same way.
+    BOOST_TEST(writer.getStream().good());
+    BOOST_CHECK_THROW(vmeSystem.measureTemperaturesAndProduceReport(),
+                      runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportWriter_Compression)
+{
+    for (ReportCompression compression : {COMPRESSION_GZIP, COMPRESSION_ZSTD})
+    {
+        fs::path path = fs::temp_directory_path() / fs::unique_path();
+        std::stringstream expected;
+        {
+            ReportWriterConfig config;
+            config.cyclesPerBatch = 4;
+            config.compression = compression;
+            ReportWriter writer(path.string(), config);
+
+            VmeSystem vmeSystem;
+            vmeSystem.setOutputStream(&writer.getStream());
+            vmeSystem.addSensor(1, SensorType::VOLTAGE_0V_10V);
+            for (int i = 0; i < 10; i++)
+                vmeSystem.measureTemperaturesAndProduceReport();
+        }
+
+        // Batches are concatenated members of a single stream.
+        std::ifstream file(path.string(), ios::binary);
+        io::filtering_istream in;
+        if (compression == COMPRESSION_GZIP)
+            in.push(io::gzip_decompressor());
+        else
+            in.push(io::zstd_decompressor());
+        in.push(file);
+        std::stringstream report;
+        io::copy(in, report);
+        fs::remove(path);
+
+        YAML::Node reportNode = YAML::Load(report.str());
+        BOOST_TEST(reportNode.size() == 10);
+    }
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ReportWriter_InvalidConfig)
+{
+    fs::path path = fs::temp_directory_path() / fs::unique_path();
+    ReportWriterConfig config;
+    config.cyclesPerBatch = 0;
+    BOOST_CHECK_THROW(ReportWriter(path.string(), config), invalid_argument);
+    BOOST_CHECK_THROW(ReportWriter("/nonexistent/report.yaml"),
+                      invalid_argument);
+}
@@ -0,0 +1,142 @@
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <boost/test/unit_test.hpp>
+#include <unistd.h>
+
+#include "ShmClient.h"
+#include "ShmPublisher.h"
+#include "TestAdc.h"
+#include "VmeSystem.h"
+
+namespace utf = boost::unit_test;
+
+namespace
+{
+string segmentName()
+{
+    return "/ttt_test_" + to_string(getpid());
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ShmPublisher_PublishSweeps, *utf::tolerance(0.00001))
+{
+    ShmPublisher publisher(segmentName(), TMOD_MAX_ADCS, 4);
+    ShmClient client(segmentName());
+    BOOST_TEST(client.getChannelCapacity() == TMOD_MAX_ADCS);
+    BOOST_TEST(client.getRingSize() == 4);
+    BOOST_TEST(client.getLatestCycle() == 0);
+
+    VmeSystem vmeSystem;
+    std::stringstream output;
+    vmeSystem.setOutputStream(&output);
+    vmeSystem.addPublisher(&publisher);
+    vmeSystem.addSensor(1, SensorType::VOLTAGE_0V_10V, 2.f, 1.f);
+    vmeSystem.addSensor(5, SensorType::CURRENT_4MA_20MA);
+    vmeSystem.measureTemperaturesAndProduceReport();
+
+    BOOST_TEST(client.getLatestCycle() == 1);
+    ShmChannelReading reading;
+    BOOST_TEST(client.readChannel(1, reading));
+    const TemperatureSensor& sensor = vmeSystem.getTemperatureSensors().at(1);
+    BOOST_TEST(reading.cycle == 1);
+    BOOST_TEST(reading.reading.hardwareId == 1);
+    BOOST_TEST(reading.reading.adcValue == sensor.getAdcValue());
+    BOOST_TEST(reading.reading.temperature == sensor.getTemperature());
+    BOOST_TEST(reading.timestampNs == vmeSystem.getLastSweep().timestampNs);
+    BOOST_TEST(!client.readChannel(2, reading));
+
+    // Removed sensors are invalidated.
+    vmeSystem.removeSensor(1);
+    for (int i = 0; i < 5; i++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(!client.readChannel(1, reading));
+    BOOST_TEST(client.readChannel(5, reading));
+    BOOST_TEST(reading.cycle == 6);
+
+    // Only the last 4 cycles are kept in the ring.
+    SweepSnapshot snapshot;
+    BOOST_TEST(!client.readCycle(2, snapshot));
+    BOOST_TEST(client.readCycle(3, snapshot));
+    BOOST_TEST(snapshot.cycle == 3);
+    BOOST_TEST(snapshot.readings.size() == 1);
+    BOOST_TEST(snapshot.readings[0].hardwareId == 5);
+    BOOST_TEST(!client.readCycle(7, snapshot));
+
+    vmeSystem.removePublisher(&publisher);
+    vmeSystem.measureTemperaturesAndProduceReport();
+    BOOST_TEST(client.getLatestCycle() == 6);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ShmPublisher_ChannelCapacity)
+{
+    // By default, the table holds the channels of the tmod backend.
+    TestAdc adc([](uint16_t, size_t) { return (int16_t)100; }, 100);
+    {
+        ShmPublisher publisher(segmentName());
+        BOOST_TEST(ShmClient(segmentName()).getChannelCapacity() == 100);
+    }
+
+    // A sweep beyond the capacity is refused, rather than truncated.
+    ShmPublisher publisher(segmentName(), 4, 4);
+    ShmClient client(segmentName());
+    SweepSnapshot snapshot;
+    snapshot.cycle = 1;
+    snapshot.readings.push_back({3, 100, 1.f, 1.f, 1.f});
+    snapshot.readings.push_back({4, 100, 1.f, 1.f, 1.f});
+    BOOST_CHECK_THROW(publisher.publish(snapshot), invalid_argument);
+    BOOST_TEST(client.getLatestCycle() == 0);
+    ShmChannelReading reading;
+    BOOST_TEST(!client.readChannel(3, reading));
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ShmClient_WaitForCycle)
+{
+    ShmPublisher publisher(segmentName());
+    ShmClient client(segmentName());
+
+    BOOST_TEST(client.waitForCycle(0, std::chrono::milliseconds(1)) == 0);
+
+    SweepSnapshot snapshot;
+    snapshot.cycle = 1;
+    snapshot.readings.push_back({3, 100, 1.f, 1.f, 1.f});
+    std::thread writer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        publisher.publish(snapshot);
+    });
+    BOOST_TEST(client.waitForCycle(0, std::chrono::seconds(10)) == 1);
+    writer.join();
+
+    BOOST_CHECK_THROW(ShmClient("/ttt_test_missing"), runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_ShmPublisher_Restart)
+{
+    SweepSnapshot snapshot;
+    snapshot.cycle = 5;
+    snapshot.readings.push_back({3, 100, 1.f, 1.f, 1.f});
+    ShmPublisher previous(segmentName(), TMOD_MAX_ADCS, 4);
+    previous.publish(snapshot);
+    ShmClient client(segmentName());
+
+    // Same layout: the mapped segment is reinitialised in place.
+    ShmPublisher restarted(segmentName(), TMOD_MAX_ADCS, 4);
+    ShmChannelReading reading;
+    BOOST_TEST(client.getLatestCycle() == 0);
+    BOOST_TEST(!client.readChannel(3, reading));
+    snapshot.cycle = 1;
+    restarted.publish(snapshot);
+    BOOST_TEST(client.readChannel(3, reading));
+    BOOST_TEST(reading.cycle == 1);
+
+    // Other layout: a new segment, the old mapping stays readable.
+    ShmPublisher resized(segmentName(), 2 * TMOD_MAX_ADCS, 4);
+    BOOST_TEST(client.readChannel(3, reading));
+    BOOST_TEST(ShmClient(segmentName()).getChannelCapacity() ==
+               2 * TMOD_MAX_ADCS);
+}
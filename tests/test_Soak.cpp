@@ -0,0 +1,141 @@
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+
+#include "AllocationCounter.h"
+#include "Clock.h"
+#include "CycleScheduler.h"
+#include "ReportReader.h"
+#include "ReportWriter.h"
+#include "VmeSystem.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+constexpr uint64_t CYCLES_PER_DAY = 24 * 60;
+constexpr uint64_t DAYS = 21;
+constexpr uint16_t SENSORS = 4;
+constexpr uint32_t BUS_LATENCY_US = 500;
+//! Allocations of a rotation, for the names of the files.
+constexpr uint64_t ALLOCATIONS_PER_ROTATION = 10;
+
+struct VirtualClockFixture
+{
+    VirtualClock clock;
+
+    VirtualClockFixture()
+    {
+        tmodSetClock(&clock);
+        tmodSetBusLatency(BUS_LATENCY_US);
+    }
+
+    ~VirtualClockFixture()
+    {
+        tmodSetBusLatency(0);
+        tmodSetClock(nullptr);
+    }
+};
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Clock_Virtual)
+{
+    VirtualClock clock;
+    const auto start = clock.now();
+    const auto steadyStart = clock.steadyNow();
+    clock.sleepFor(std::chrono::hours(24));
+    clock.sleepUntil(steadyStart + std::chrono::hours(12));
+    clock.advance(std::chrono::seconds(-5));
+    BOOST_TEST((clock.now() - start == std::chrono::hours(24)));
+    BOOST_TEST((clock.steadyNow() - steadyStart == std::chrono::hours(24)));
+
+    CycleScheduler scheduler(clock, std::chrono::seconds(60));
+    scheduler.run(3, [&]() { clock.advance(std::chrono::seconds(90)); });
+    BOOST_TEST(scheduler.getCycleCount() == 3);
+    BOOST_TEST(scheduler.getOverrunCount() == 2);
+    BOOST_CHECK_THROW(CycleScheduler(clock, std::chrono::seconds(0)),
+                      invalid_argument);
+}
+
+BOOST_FIXTURE_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_Soak_ThreeWeeksOfMinuteCycles, VirtualClockFixture)
+{
+    const fs::path directory = fs::temp_directory_path() / fs::unique_path();
+    fs::create_directories(directory);
+    const std::string path = (directory / "report.yaml").string();
+
+    ReportWriterConfig config;
+    config.cyclesPerBatch = 10;
+    config.fsyncPolicy = FSYNC_EVERY_T_MS;
+    config.fsyncPeriod = std::chrono::minutes(30);
+    config.rotationPeriod = std::chrono::hours(24);
+    {
+        ReportWriter writer(path, config, clock);
+        VmeSystem vmeSystem;
+        vmeSystem.setClock(&clock);
+        vmeSystem.setOutputStream(&writer.getStream());
+        for (uint16_t hardwareId = 0; hardwareId < SENSORS; hardwareId++)
+            vmeSystem.addSensor(hardwareId, SensorType::VOLTAGE_0V_10V);
+
+        // The minimum and maximum only ever widen, and bound the readings.
+        std::vector<float> minTemperatures(SENSORS, 1e9f);
+        std::vector<float> maxTemperatures(SENSORS, -1e9f);
+        bool consistent = true;
+        // Nothing but the daily rotations allocates in the long run.
+        uint64_t lastWeekAllocations = 0;
+        size_t lastWeekRotations = 0;
+        const auto cycle = [&]() {
+            const uint64_t lastWeek = CYCLES_PER_DAY * (DAYS - 7);
+            if (vmeSystem.getLastSweep().cycle == lastWeek)
+            {
+                lastWeekAllocations = processAllocationCount();
+                lastWeekRotations = writer.getRotationCount();
+            }
+            vmeSystem.measureTemperaturesAndProduceReport();
+            for (const auto& reading : vmeSystem.getLastSweep().readings)
+            {
+                float& min = minTemperatures[reading.hardwareId];
+                float& max = maxTemperatures[reading.hardwareId];
+                consistent = consistent && reading.minTemperature <= min &&
+                             reading.maxTemperature >= max &&
+                             reading.minTemperature <= reading.temperature &&
+                             reading.temperature <= reading.maxTemperature;
+                min = reading.minTemperature;
+                max = reading.maxTemperature;
+            }
+        };
+
+        CycleScheduler scheduler(clock, std::chrono::seconds(60));
+        scheduler.run(CYCLES_PER_DAY * DAYS, cycle);
+        lastWeekAllocations = processAllocationCount() - lastWeekAllocations;
+        lastWeekRotations = writer.getRotationCount() - lastWeekRotations;
+        BOOST_TEST(lastWeekRotations == 7);
+        BOOST_TEST(lastWeekAllocations <=
+                   lastWeekRotations * ALLOCATIONS_PER_ROTATION);
+
+        BOOST_TEST(consistent);
+        BOOST_TEST(scheduler.getOverrunCount() == 0);
+        BOOST_TEST(scheduler.getCycleCount() == CYCLES_PER_DAY * DAYS);
+        const auto expected =
+            std::chrono::minutes(CYCLES_PER_DAY * DAYS - 1);
+        BOOST_TEST((clock.getElapsed() >= expected));
+        BOOST_TEST((clock.getElapsed() < expected + std::chrono::minutes(1)));
+        BOOST_TEST(writer.getRotationCount() == DAYS - 1);
+        BOOST_TEST(writer.getFsyncCount() >= DAYS * 24 * 2 - 1);
+    }
+
+    // A rotated file holds a day of cycles. Rotation is checked once per
+    // batch, and the first file is opened a batch before its first commit.
+    for (uint64_t day = 1; day < DAYS; day++)
+    {
+        const uint64_t cycles =
+            CYCLES_PER_DAY + (day == 1 ? config.cyclesPerBatch : 0);
+        ReportReader reader(path + "." + std::to_string(day), false);
+        BOOST_TEST(reader.getIndex().getBlocks().size() == cycles * SENSORS);
+    }
+    fs::remove_all(directory);
+}
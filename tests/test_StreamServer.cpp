@@ -0,0 +1,232 @@
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include <boost/filesystem.hpp>
+#include <boost/test/unit_test.hpp>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "StreamServer.h"
+#include "VmeSystem.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+int connectClient(const string& path, const StreamSubscription& subscription)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+    BOOST_REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) == 0);
+    string frame;
+    encodeSubscribe(subscription, frame);
+    BOOST_REQUIRE(send(fd, frame.data(), frame.size(), 0) ==
+                  (ssize_t)frame.size());
+    return fd;
+}
+
+bool readFully(int fd, char* data, size_t size)
+{
+    while (size > 0)
+    {
+        pollfd readable = {fd, POLLIN, 0};
+        if (poll(&readable, 1, 5000) != 1)
+            return false;
+        const ssize_t received = recv(fd, data, size, 0);
+        if (received <= 0)
+            return false;
+        data += received;
+        size -= (size_t)received;
+    }
+    return true;
+}
+
+bool readSweep(int fd, SweepSnapshot& snapshot)
+{
+    uint32_t length;
+    if (!readFully(fd, reinterpret_cast<char*>(&length), sizeof(length)))
+        return false;
+    string payload(length, '\0');
+    return readFully(fd, payload.data(), length) &&
+           decodeSweep(payload.data(), length, snapshot);
+}
+
+template <typename Predicate>
+bool waitFor(Predicate predicate)
+{
+    for (int i = 0; i < 5000 && !predicate(); i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return predicate();
+}
+} // namespace
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_StreamProtocol_RoundTrip)
+{
+    StreamSubscription subscription;
+    subscription.decimation = 3;
+    subscription.channels = {1, 7};
+    string frame;
+    encodeSubscribe(subscription, frame);
+    StreamSubscription decoded;
+    BOOST_TEST(decodeSubscribe(frame.data() + STREAM_LENGTH_SIZE,
+                               frame.size() - STREAM_LENGTH_SIZE, decoded));
+    BOOST_TEST(decoded.decimation == 3);
+    BOOST_TEST(decoded.channels == subscription.channels,
+               boost::test_tools::per_element());
+    BOOST_TEST(!decodeSubscribe(frame.data(), frame.size(), decoded));
+
+    SweepSnapshot snapshot;
+    snapshot.cycle = 12;
+    snapshot.timestampNs = 34;
+    snapshot.readings = {{1, 10, 1.f, 1.f, 1.f}, {2, 20, 2.f, 2.f, 2.f}};
+    frame.clear();
+    encodeSweep(snapshot, {false, false, true}, frame);
+    SweepSnapshot sweep;
+    BOOST_TEST(decodeSweep(frame.data() + STREAM_LENGTH_SIZE,
+                           frame.size() - STREAM_LENGTH_SIZE, sweep));
+    BOOST_TEST(sweep.cycle == 12);
+    BOOST_TEST(sweep.timestampNs == 34);
+    BOOST_TEST(sweep.readings.size() == 1);
+    BOOST_TEST(sweep.readings[0].adcValue == 20);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_StreamServer_Subscriptions)
+{
+    const string path =
+        (fs::temp_directory_path() / fs::unique_path()).string();
+    StreamServer server(path);
+
+    StreamSubscription filtered;
+    filtered.decimation = 2;
+    filtered.channels = {3};
+    const int filteredFd = connectClient(path, filtered);
+    const int allFd = connectClient(path, StreamSubscription());
+    BOOST_REQUIRE(
+        waitFor([&]() { return server.getSubscriberCount() == 2; }));
+
+    VmeSystem vmeSystem;
+    std::stringstream output;
+    vmeSystem.setOutputStream(&output);
+    vmeSystem.addPublisher(&server);
+    vmeSystem.addSensor(1, SensorType::VOLTAGE_0V_10V);
+    vmeSystem.addSensor(3, SensorType::VOLTAGE_0V_10V);
+    for (int i = 0; i < 4; i++)
+        vmeSystem.measureTemperaturesAndProduceReport();
+
+    SweepSnapshot sweep;
+    for (uint64_t cycle = 1; cycle <= 4; cycle++)
+    {
+        BOOST_REQUIRE(readSweep(allFd, sweep));
+        BOOST_TEST(sweep.cycle == cycle);
+        BOOST_TEST(sweep.readings.size() == 2);
+    }
+    // One sweep out of two, channel 3 only.
+    for (uint64_t cycle : {1, 3})
+    {
+        BOOST_REQUIRE(readSweep(filteredFd, sweep));
+        BOOST_TEST(sweep.cycle == cycle);
+        BOOST_TEST(sweep.readings.size() == 1);
+        BOOST_TEST(sweep.readings[0].hardwareId == 3);
+    }
+
+    close(filteredFd);
+    close(allFd);
+    BOOST_TEST(waitFor([&]() { return server.getSubscriberCount() == 0; }));
+    BOOST_TEST(server.getSlowConsumerCount() == 0);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_StreamServer_SlowConsumer)
+{
+    const string path =
+        (fs::temp_directory_path() / fs::unique_path()).string();
+    StreamServerConfig config;
+    config.maxQueuedBytes = 1024;
+    config.socketBufferSize = 4096;
+    StreamServer server(path, config);
+
+    // Hundreds of subscribers, one of them never reads.
+    vector<int> fds;
+    for (int i = 0; i < 200; i++)
+        fds.push_back(connectClient(path, StreamSubscription()));
+    BOOST_REQUIRE(
+        waitFor([&]() { return server.getSubscriberCount() == 200; }));
+
+    SweepSnapshot snapshot;
+    for (uint16_t c = 0; c < TMOD_MAX_ADCS; c++)
+        snapshot.readings.push_back({c, 0, 0.f, 0.f, 0.f});
+    SweepSnapshot sweep;
+    for (uint64_t cycle = 1; server.getSlowConsumerCount() == 0; cycle++)
+    {
+        BOOST_REQUIRE(cycle < 100000);
+        snapshot.cycle = cycle;
+        const auto start = std::chrono::steady_clock::now();
+        server.publish(snapshot);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        BOOST_TEST(std::chrono::duration_cast<std::chrono::milliseconds>(
+                       elapsed)
+                       .count() < 100);
+        for (size_t i = 1; i < fds.size(); i++)
+            BOOST_REQUIRE(readSweep(fds[i], sweep));
+    }
+
+    BOOST_TEST(server.getSlowConsumerCount() == 1);
+    BOOST_TEST(
+        waitFor([&]() { return server.getSubscriberCount() == 199; }));
+    // The slow consumer was disconnected, the others are still served.
+    char buffer[4096];
+    while (recv(fds[0], buffer, sizeof(buffer), MSG_DONTWAIT) > 0)
+        ;
+    BOOST_TEST(recv(fds[0], buffer, sizeof(buffer), 0) == 0);
+    for (int fd : fds)
+        close(fd);
+}
+
+BOOST_AUTO_TEST_CASE( // NOLINT(cert-err58-cpp)
+    test_StreamServer_OversizedRequest)
+{
+    const string path =
+        (fs::temp_directory_path() / fs::unique_path()).string();
+    StreamServer server(path);
+    const int subscriberFd = connectClient(path, StreamSubscription());
+    BOOST_REQUIRE(waitFor([&]() { return server.getSubscriberCount() == 1; }));
+
+    // A request longer than any subscription, sent without end: the client
+    // is disconnected as soon as its length prefix is read.
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path.c_str());
+    BOOST_REQUIRE(connect(fd, reinterpret_cast<sockaddr*>(&address),
+                          sizeof(address)) == 0);
+    string data(64 * 1024, '\xff');
+    size_t sent = 0;
+    while (sent < 1024 * data.size())
+    {
+        const ssize_t size = send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (size <= 0)
+            break;
+        sent += (size_t)size;
+    }
+    BOOST_TEST(sent < 1024 * data.size());
+    close(fd);
+
+    // The other subscribers are still served.
+    SweepSnapshot snapshot;
+    snapshot.cycle = 1;
+    snapshot.readings.push_back({3, 100, 1.f, 1.f, 1.f});
+    server.publish(snapshot);
+    SweepSnapshot sweep;
+    BOOST_TEST(readSweep(subscriberFd, sweep));
+    BOOST_TEST(sweep.cycle == 1);
+    close(subscriberFd);
+}
@@ -0,0 +1,106 @@
+// C++ Sytem includes
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Own libraries includes
+#include "ReportMerger.h"
+
+using namespace std;
+
+namespace
+{
+void usage()
+{
+    cerr << "Usage: report_merge [--tolerance MS] [--follow] [--output FILE] "
+            "SOURCE...\n"
+            "  SOURCE is NAME=REPORT for a YAML report, possibly .gz or "
+            ".zst,\n"
+            "  or NAME=sweeps:CAPTURE for a capture of a live stream.\n"
+            "  NAME prefixes the sensor entries of the source, e.g. "
+            "crate1/2-PT1000.\n"
+            "  --tolerance combines the cycles of different sources at most "
+            "MS\n"
+            "  milliseconds apart, 0 by default.\n"
+            "  --follow tails the sources until interrupted.\n";
+}
+} // namespace
+
+/**
+ * Merge reports in time order into a single report.
+ * Archives are merged in batch; with --follow, the sources are tailed and
+ * each cycle is written once every source has moved past it.
+ */
+int main(int argc, char* argv[])
+{
+    long tolerance = 0;
+    bool follow = false;
+    string outputPath;
+    vector<string> sourceArguments;
+    for (int i = 1; i < argc; i++)
+    {
+        const string option = argv[i];
+        if (option == "--follow")
+            follow = true;
+        else if (option == "--tolerance" && i + 1 < argc)
+            tolerance = strtol(argv[++i], nullptr, 10);
+        else if (option == "--output" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (option.find('=') != string::npos)
+            sourceArguments.push_back(option);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+    if (sourceArguments.empty())
+    {
+        usage();
+        return 1;
+    }
+
+    try
+    {
+        vector<unique_ptr<ReportSource>> sources;
+        for (const string& argument : sourceArguments)
+        {
+            const size_t equal = argument.find('=');
+            const string name = argument.substr(0, equal);
+            const string path = argument.substr(equal + 1);
+            if (path.compare(0, 7, "sweeps:") == 0)
+                sources.push_back(make_unique<SweepCaptureSource>(
+                    path.substr(7), name, follow));
+            else
+                sources.push_back(
+                    make_unique<YamlReportSource>(path, name, follow));
+        }
+
+        ofstream file;
+        if (!outputPath.empty())
+        {
+            file.open(outputPath, ios::binary | ios::app);
+            if (!file.is_open())
+            {
+                cerr << "Impossible to access " << outputPath << ".\n";
+                return 1;
+            }
+        }
+        ReportMerger merger(std::move(sources),
+                            outputPath.empty() ? cout : file,
+                            chrono::milliseconds(tolerance));
+        while (merger.run() == MERGE_NEED_MORE_DATA)
+            this_thread::sleep_for(chrono::milliseconds(200));
+    }
+    catch (const exception& e)
+    {
+        cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+// C++ Sytem includes
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+
+// Third parties C++ includes
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+// Own libraries includes
+#include "ReportReader.h"
+
+using namespace std;
+
+namespace
+{
+void usage()
+{
+    cerr << "Usage: report_query REPORT [--sensor KEY] [--from TIME] "
+            "[--to TIME] [--keys]\n"
+            "  KEY is a sensor entry, e.g. 2-PT1000.\n"
+            "  TIME is a report timestamp, e.g. \"2021-Feb-09 20:55:51\".\n"
+            "  --keys lists the sensor entries of the report.\n";
+}
+
+int64_t parseTime(const char* text)
+{
+    int64_t time = ReportIndex::parseTimestamp(text, strlen(text));
+    if (time < 0)
+    {
+        cerr << "Invalid time: " << text << "\n";
+        exit(1);
+    }
+    return time;
+}
+} // namespace
+
+/**
+ * Print the readings of a report in a time range, for one or all sensors.
+ * The sidecar index is built on first use, and later queries only decode
+ * the matching entries.
+ */
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        usage();
+        return 1;
+    }
+
+    string sensorKey;
+    int64_t fromMs = numeric_limits<int64_t>::min();
+    int64_t toMs = numeric_limits<int64_t>::max();
+    bool listKeys = false;
+    for (int i = 2; i < argc; i++)
+    {
+        const string option = argv[i];
+        if (option == "--keys")
+            listKeys = true;
+        else if (i + 1 >= argc)
+        {
+            usage();
+            return 1;
+        }
+        else if (option == "--sensor")
+            sensorKey = argv[++i];
+        else if (option == "--from")
+            fromMs = parseTime(argv[++i]);
+        else if (option == "--to")
+            toMs = parseTime(argv[++i]);
+        else
+        {
+            usage();
+            return 1;
+        }
+    }
+
+    ReportReader reader(argv[1]);
+    if (listKeys)
+    {
+        for (const auto& key : reader.getIndex().getSensorKeys())
+            cout << key << "\n";
+        return 0;
+    }
+
+    using namespace boost::posix_time;
+    const ptime epoch(boost::gregorian::date(1970, 1, 1));
+    for (const auto& sample : reader.query(fromMs, toMs, sensorKey))
+    {
+        cout << to_simple_string(epoch + milliseconds(sample.timestampMs))
+             << "\t" << sample.sensorKey << "\t" << sample.temperature << "\t"
+             << sample.minTemperature << "\t" << sample.maxTemperature
+             << "\n";
+    }
+    return 0;
+}